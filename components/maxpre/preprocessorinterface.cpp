@@ -31,6 +31,19 @@ namespace maxPreprocessor {
 		skipTechnique = 0;
 	}
 	
+	PreprocessorInterface::PreprocessorInterface(const vector<int>& solverToPP, int variables_, int originalVariables_, const Trace& trace, uint64_t topWeight_)
+	: preprocessor({}, {}, topWeight_) {
+		topWeight = topWeight_;
+		variables = variables_;
+		originalVariables = originalVariables_;
+		preprocessed = true;
+		useBVEGateExtraction = false;
+		useLabelMatching = false;
+		skipTechnique = 0;
+		solverVarToPPVar = solverToPP;
+		preprocessor.trace = trace;
+	}
+	
 	void PreprocessorInterface::preprocess(string techniques, int logLevel, double timeLimit) {
 		preprocessor.logLevel = logLevel;
 		preprocessor.printComments = false;
@@ -75,6 +88,13 @@ namespace maxPreprocessor {
 		return preprocessor.trace.getSolution(ppTrueLiterals, 0, variables, originalVariables).F;
 	}
 	
+	void PreprocessorInterface::getReconstructionState(vector<int>& retSolverToPP, int& retVariables, int& retOriginalVariables, Trace& retTrace) {
+		retSolverToPP = solverVarToPPVar;
+		retVariables = variables;
+		retOriginalVariables = originalVariables;
+		retTrace = preprocessor.trace;
+	}
+	
 	void PreprocessorInterface::printSolution(const vector<int>& trueLiterals, ostream& output, uint64_t ansWeight) {
 		vector<int> ppTrueLiterals;
 		for (int lit : trueLiterals) {
@@ -21,6 +21,8 @@ private:
 	int litToPP(int lit);
 public:
 	PreprocessorInterface(const std::vector<std::vector<int> >& clauses, const std::vector<uint64_t>& weights, uint64_t topWeight_);
+	// Restores only what reconstruct needs, as saved by getReconstructionState
+	PreprocessorInterface(const std::vector<int>& solverToPP, int variables_, int originalVariables_, const Trace& trace, uint64_t topWeight_);
 	void preprocess(std::string techniques, int logLevel = 0, double timeLimit = 1e9);
 	
 	void addClause(const std::vector<int>& clause);
@@ -31,6 +33,7 @@ public:
 	
 	void getInstance(std::vector<std::vector<int> >& retClauses, std::vector<uint64_t>& retWeights, std::vector<int>& retLabels);
 	std::vector<int> reconstruct(const std::vector<int>& trueLiterals);
+	void getReconstructionState(std::vector<int>& retSolverToPP, int& retVariables, int& retOriginalVariables, Trace& retTrace);
 	std::vector<std::pair<int, std::pair<int, int> > > getCondEdges();
 	
 	void printInstance(std::ostream& output, int outputFormat = 0);
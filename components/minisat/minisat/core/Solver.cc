@@ -21,6 +21,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <math.h>
 #include <chrono>
 #include <limits>
+#include <algorithm>
 
 #include "minisat/mtl/Alg.h"
 #include "minisat/mtl/Sort.h"
@@ -71,6 +72,7 @@ Solver::Solver() :
   , luby_restart     (opt_luby_restart)
   , ccmin_mode       (opt_ccmin_mode)
   , phase_saving     (opt_phase_saving)
+  , trail_saving     (false)
   , rnd_pol          (false)
   , rnd_init_act     (opt_rnd_init_act)
   , garbage_frac     (opt_garbage_frac)
@@ -91,6 +93,7 @@ Solver::Solver() :
     //
   , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0)
   , dec_vars(0), num_clauses(0), num_learnts(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
+  , reused_levels(0)
 
   , watches            (WatcherDeleted(ca))
   , order_heap         (VarOrderLt(activity))
@@ -162,10 +165,7 @@ void Solver::releaseVar(Lit l)
 
 bool Solver::addClause_(vec<Lit>& ps)
 {
-
-
-    assert(decisionLevel() == 0);
-
+    // the assumption levels kept by 'trail_saving' may not hold with the clause
     cancelUntil(0);
 
     if (!ok) {
@@ -739,57 +739,85 @@ bool Solver::simplify()
     return true;
 }
 
-bool Solver::isDisjointCore(LSet * confl) {
-
-    for (int k = 0; k < out_conflicts.size(); ++k) {
-        for (int ii = 0; ii < confl->size(); ++ii) {
-            if (out_conflicts[k]->has((*confl)[ii]))
-                return false;
-        }
+Solver::Core Solver::pushCore(const LSet& confl)
+{
+    Core c;
+    c.begin = core_lits.size();
+    c.size  = confl.size();
+    c.sig   = 0;
+    for (int i = 0; i < confl.size(); i++){
+        core_lits.push(confl[i]);
+        c.sig |= (uint64_t)1 << (var(confl[i]) & 63);
     }
+    sort(&core_lits[c.begin], c.size);
+    return c;
+}
 
-    return true;    
+void Solver::addCore(const Core& c)
+{
+    cores.push(c);
+    for (int i = 0; i < c.size; i++){
+        Lit p = core_lits[c.begin + i];
+        core_occurs.reserve(p, 0);
+        core_occurs[p]++;
+    }
 }
 
-bool Solver::isDuplicateCore(LSet * confl) {
+void Solver::removeCore(int i)
+{
+    const Core& c = cores[i];
+    for (int k = 0; k < c.size; k++)
+        core_occurs[core_lits[c.begin + k]]--;
+    cores[i] = cores.last();
+    cores.pop();
+}
 
-    for (int k = 0; k < out_conflicts.size(); ++k) {
+void Solver::clearCores()
+{
+    while (cores.size() > 0)
+        removeCore(cores.size() - 1);
+    core_lits.clear();
+}
 
-        if (confl->size() < out_conflicts[k]->size()) {
-            for (int ii = 0; ii < confl->size(); ++ii) {
-                if (!out_conflicts[k]->has((*confl)[ii]))
-                    goto test_continue;
-            }
-            /*
-            printf("c subsumes earlier conflict\n");
-            printf("c analyzeFinal reduced core %d -> %d\n", 
-                out_conflicts[k]->size(), confl->size());
-            */
-            delete out_conflicts[k];
-            out_conflicts[k] = out_conflicts.last();
-            out_conflicts.pop();
-            goto test_continue;
-        } else if (confl->size() > out_conflicts[k]->size()) {
-            for (int ii = 0; ii < out_conflicts[k]->size(); ++ii) {
-                if (!confl->has((*out_conflicts[k])[ii]))
-                    goto test_continue;
-            }
-            //printf("c subsumed by earlier conflict\n");
-        } else { // same size
-            for (int ii = 0; ii < confl->size(); ++ii) {
-                if (!out_conflicts[k]->has((*confl)[ii]))
-                    goto test_continue;
-            }
-        }   
+bool Solver::subsumes(const Core& a, const Core& b) const
+{
+    if (a.size > b.size || (a.sig & ~b.sig) != 0) return false;
+
+    // both are sorted
+    const Lit* p = &core_lits[a.begin];
+    const Lit* q = &core_lits[b.begin];
+    const Lit* q_end = q + b.size;
+    for (int i = 0; i < a.size; i++){
+        while (q != q_end && *q < p[i]) q++;
+        if (q == q_end || *q != p[i]) return false;
+        q++;
+    }
+    return true;
+}
 
-        return true;
-        test_continue: continue;
+bool Solver::isDisjointCore(const Core& c) const
+{
+    for (int i = 0; i < c.size; i++){
+        Lit p = core_lits[c.begin + i];
+        if (core_occurs.has(p) && core_occurs[p] > 0)
+            return false;
     }
+    return true;
+}
 
+bool Solver::isDuplicateCore(const Core& c)
+{
+    for (int k = 0; k < cores.size(); k++){
+        if (subsumes(cores[k], c))
+            return true;
+        if (subsumes(c, cores[k]))
+            // c is smaller, the earlier core is redundant
+            removeCore(k--);
+    }
     return false;
 }
 
-bool Solver::getFinalConflict(vec<Lit> & assumps, LSet * out_conflict) 
+bool Solver::getFinalConflict(vec<Lit> & assumps, LSet & out_conflict) 
 {   
     cancelUntil(0);
 
@@ -802,7 +830,7 @@ bool Solver::getFinalConflict(vec<Lit> & assumps, LSet * out_conflict)
             newDecisionLevel();
             continue;
         } else if (value(p) == l_False) {
-            analyzeFinal(~p, *out_conflict);
+            analyzeFinal(~p, out_conflict);
             return true;
         } else {
             // create new decision level and propagate p
@@ -863,8 +891,7 @@ void Solver::shuffle() {
         //printf("shufflen %d / %d\n", shuffles, n_shuffles);
         randomizeAssumptions();
 
-        LSet * new_conflict = new LSet();
-        bool hasConflict = getFinalConflict(assumptions, new_conflict);
+        bool hasConflict = getFinalConflict(assumptions, shuffle_conflict);
 
         if (!hasConflict) {
             printf("!!!!!!!!!!!!!! shuffle not conflicting!\n"); //exit(1);
@@ -872,23 +899,18 @@ void Solver::shuffle() {
         }
     /*
         printf("c shuffle core");
-        for (int ii = 0; ii < new_conflict->size(); ++ii) {
-            Lit l = (*new_conflict)[ii];
+        for (int ii = 0; ii < shuffle_conflict.size(); ++ii) {
+            Lit l = shuffle_conflict[ii];
             printf(" %d", var(l) * (1  - 2 * sign(l)));
         }
         printf("\n");
     */
 
-        if (isDuplicateCore(new_conflict)) {
-            new_conflict->clear();
-            delete new_conflict;
-        } else {
-            if (shuffle_disjoint && !isDisjointCore(new_conflict)) {
-                delete new_conflict;
-            } else {
-                out_conflicts.push(new_conflict);
-            }
-        }
+        Core c = pushCore(shuffle_conflict);
+        if (isDuplicateCore(c) || (shuffle_disjoint && !isDisjointCore(c)))
+            core_lits.shrink(c.size);
+        else
+            addCore(c);
     }
     
     auto end = std::chrono::high_resolution_clock::now();
@@ -919,12 +941,6 @@ lbool Solver::search(int nof_conflicts)
     vec<Lit>    learnt_clause;
     starts++;
 
-    for (int i = 0; i < out_conflicts.size(); ++i) {
-        out_conflicts[i]->clear();
-        delete out_conflicts[i];
-    }
-    out_conflicts.clear();
-
 
     for (;;){
         CRef confl = propagate();
@@ -989,10 +1005,7 @@ lbool Solver::search(int nof_conflicts)
                 }else if (value(p) == l_False){
 
                     analyzeFinal(~p, conflict);
-                    LSet * new_conflict = new LSet();
-                    for (int i = 0; i < conflict.size(); ++i) 
-                        new_conflict->insert(conflict[i]);
-                    out_conflicts.push(new_conflict);
+                    addCore(pushCore(conflict));
 /*
                     if (!test) {
                         test = true;
@@ -1010,8 +1023,8 @@ lbool Solver::search(int nof_conflicts)
 */
 /*
                     printf("c search core");
-                    for (int ii = 0; ii < new_conflict->size(); ++ii)
-                        printf(" %d", toInt((*new_conflict)[ii]));
+                    for (int ii = 0; ii < conflict.size(); ++ii)
+                        printf(" %d", toInt(conflict[ii]));
                     printf("\n");
 */
                     if (do_shuffle) shuffle();
@@ -1088,6 +1101,7 @@ lbool Solver::solve_()
 {
     model.clear();
     conflict.clear();
+    clearCores();
     if (!ok) return l_False;
 
     solves++;
@@ -1100,6 +1114,16 @@ lbool Solver::solve_()
     learntsize_adjust_cnt     = (int)learntsize_adjust_confl;
     lbool   status            = l_Undef;
 
+    // Keep the decision levels of the assumptions this call starts with
+    // from the last one, they are propagated already:
+    int reused = 0;
+    if (trail_saving){
+        int n = std::min(decisionLevel(), std::min(assumptions.size(), trail_assumps.size()));
+        while (reused < n && assumptions[reused] == trail_assumps[reused]) reused++;
+    }
+    cancelUntil(reused);
+    reused_levels += reused;
+
     if (verbosity >= 1){
         printf("============================[ Search Statistics ]==============================\n");
         printf("| Conflicts |          ORIGINAL         |          LEARNT          | Progress |\n");
@@ -1129,13 +1153,19 @@ lbool Solver::solve_()
         ok = false;
     }
 
-    cancelUntil(0);
+    // Levels up to the number of assumptions are for the assumptions, in
+    // order (after shuffling, in the shuffled order).
+    int keep = trail_saving ? std::min(decisionLevel(), assumptions.size()) : 0;
+    cancelUntil(keep);
+    trail_assumps.clear();
+    for (int i = 0; i < keep; i++) trail_assumps.push(assumptions[i]);
     return status;
 }
 
 
 bool Solver::implies(const vec<Lit>& assumps, vec<Lit>& out)
 {
+    cancelUntil(0);
     trail_lim.push(trail.size());
     for (int i = 0; i < assumps.size(); i++){
         Lit a = assumps[i];
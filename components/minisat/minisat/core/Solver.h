@@ -54,12 +54,16 @@ public:
     long shuffle_time;
     bool do_shuffle;
     bool shuffle_disjoint;
-    vec<LSet*> out_conflicts;
 
-    bool isDuplicateCore(LSet * confl);
+    // The final conflicts of the last call, the one found by search first
+    // and then the distinct ones found by shuffling. The literals of each
+    // are sorted.
+    int        nCores   ()      const { return cores.size(); }
+    int        coreSize (int i) const { return cores[i].size; }
+    const Lit* coreLits (int i) const { return &core_lits[cores[i].begin]; }
+
     void randomizeAssumptions();
-    bool isDisjointCore(LSet * confl);
-    bool getFinalConflict(vec<Lit> & assumps, LSet * out_conflict);
+    bool getFinalConflict(vec<Lit> & assumps, LSet & out_conflict);
     void shuffle();
 
     // Problem specification:
@@ -159,6 +163,7 @@ public:
     bool      luby_restart;
     int       ccmin_mode;         // Controls conflict clause minimization (0=none, 1=basic, 2=deep).
     int       phase_saving;       // Controls the level of phase saving (0=none, 1=limited, 2=full).
+    bool      trail_saving;       // Keep the assumption levels between calls, and reuse those the next assumptions start with.
     bool      rnd_pol;            // Use random polarities for branching heuristics.
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
     double    garbage_frac;       // The fraction of wasted memory allowed before a garbage collection is triggered.
@@ -176,6 +181,7 @@ public:
     //
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts;
     uint64_t dec_vars, num_clauses, num_learnts, clauses_literals, learnts_literals, max_literals, tot_literals;
+    uint64_t reused_levels;
 
 protected:
 
@@ -218,6 +224,15 @@ protected:
     vec<Lit>            trail;            // Assignment stack; stores all assigments made in the order they were made.
     vec<int>            trail_lim;        // Separator indices for different decision levels in 'trail'.
     vec<Lit>            assumptions;      // Current set of assumptions provided to solve by the user.
+    vec<Lit>            trail_assumps;    // The assumptions of the decision levels kept from the last call, if 'trail_saving'.
+
+    // A core in 'core_lits', with a signature of its variables for quick
+    // subset tests. 'sig' of a subset of a core has no bits the core's lacks.
+    struct Core { int begin; int size; uint64_t sig; };
+    vec<Core>           cores;            // The cores of 'nCores()'.
+    vec<Lit>            core_lits;        // The literals of the cores, and possibly of removed ones, until the next call.
+    LMap<int>           core_occurs;      // The number of cores each literal is in.
+    LSet                shuffle_conflict; // Conflict of the current shuffle.
 
     VMap<double>        activity;         // A heuristic measurement of the activity of a variable.
     VMap<lbool>         assigns;          // The current assignments.
@@ -276,6 +291,13 @@ protected:
     CRef     boundPropagate   ();                                                      // Perform upper bound propagation.
     void     cancelUntil      (int level);                                             // Backtrack until a certain level.
     void     analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel);    // (bt = backtrack)
+    Core     pushCore         (const LSet& confl);                                     // Store the literals of 'confl' after the cores, sorted.
+    void     addCore          (const Core& c);                                         // Make a pushed core the last one of 'cores'.
+    void     removeCore       (int i);                                                 // Remove core 'i', the last one takes its place.
+    void     clearCores       ();
+    bool     subsumes         (const Core& a, const Core& b) const;                    // Is 'a' a subset of 'b'?
+    bool     isDuplicateCore  (const Core& c);                                         // Is a core a subset of 'c'? Removes the cores 'c' is a subset of.
+    bool     isDisjointCore   (const Core& c) const;                                   // Does 'c' share no literals with the cores?
     void     analyzeFinal     (Lit p, LSet& out_conflict);                             // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
     bool     litRedundant     (Lit p);                                                 // (helper method for 'analyze()')
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
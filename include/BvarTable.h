@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "Weights.h"
+
+// Dense index space for the bvars (soft clause labels) of an instance.
+// Per-bvar data is kept in parallel arrays indexed 0..size()-1 and
+// index(var) maps a variable to its position. Removing a bvar moves the
+// last one into its slot, so indices are only stable between removals.
+class BvarTable {
+ public:
+  unsigned size() const { return vars.size(); }
+  bool empty() const { return vars.empty(); }
+
+  // position of var, -1 if var is not a bvar
+  int index(int var) const {
+    return unsigned(var) < idx.size() ? idx[var] : -1;
+  }
+  bool contains(int var) const { return index(var) >= 0; }
+
+  // returns the index of the new bvar
+  unsigned add(int var, weight_t weight) {
+    if (unsigned(var) >= idx.size()) idx.resize(var + 1, -1);
+    idx[var] = vars.size();
+    vars.push_back(var);
+    weights.push_back(weight);
+    soft_clauses.emplace_back();
+    return vars.size() - 1;
+  }
+
+  void remove(int var) {
+    int i = index(var);
+    if (i < 0) return;
+    unsigned last = vars.size() - 1;
+    idx[vars[last]] = i;
+    vars[i] = vars[last];
+    weights[i] = weights[last];
+    soft_clauses[i].swap(soft_clauses[last]);
+    idx[var] = -1;
+    vars.pop_back();
+    weights.pop_back();
+    soft_clauses.pop_back();
+  }
+
+  int var(unsigned i) const { return vars[i]; }
+  weight_t weight(unsigned i) const { return weights[i]; }
+  // ids of the soft clauses labelled by bvar i
+  const std::vector<unsigned> & clauses(unsigned i) const { return soft_clauses[i]; }
+  void addClause(unsigned i, unsigned clause_id) { soft_clauses[i].push_back(clause_id); }
+
+  // var must be a bvar
+  weight_t weightOf(int var) const { return weights[idx[var]]; }
+
+  // iteration over (var, weight) pairs in index order
+  class const_iterator {
+   public:
+    const_iterator(const BvarTable & t, unsigned i) : t(t), i(i) { }
+    std::pair<int, weight_t> operator*() const { return {t.vars[i], t.weights[i]}; }
+    const_iterator & operator++() { ++i; return *this; }
+    bool operator!=(const const_iterator & o) const { return i != o.i; }
+   private:
+    const BvarTable & t;
+    unsigned i;
+  };
+  const_iterator begin() const { return const_iterator(*this, 0); }
+  const_iterator end() const { return const_iterator(*this, size()); }
+
+ private:
+  std::vector<int> idx;
+  std::vector<int> vars;
+  std::vector<weight_t> weights;
+  std::vector<std::vector<unsigned>> soft_clauses;
+};
+
+// Boolean flag per variable, false for variables never set.
+class VarFlags {
+ public:
+  bool operator[](int var) const {
+    return unsigned(var) < flags.size() && flags[var];
+  }
+  void set(int var, bool value = true) {
+    if (unsigned(var) >= flags.size()) {
+      if (!value) return;
+      flags.resize(var + 1, false);
+    }
+    flags[var] = value;
+  }
+
+ private:
+  std::vector<bool> flags;
+};
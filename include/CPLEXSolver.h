@@ -5,6 +5,8 @@
 #include <string>
 #include "Util.h"
 #include "Weights.h"
+#include "BvarTable.h"
+#include "HSSolver.h"
 #include "Timer.h"
 #include "GlobalConfig.h"
 
@@ -12,18 +14,15 @@
 
 class ProblemInstance;
 
-class CPLEXSolver {
+class CPLEXSolver : public HSSolver {
 
  public:
 
-  enum Status { Failed, Feasible, Optimal };
-  enum Comparator { LTE, GTE };
-
   CPLEXSolver();
   ~CPLEXSolver();
   void addVariable(int var);
   void addObjectiveVariable(int bVar, weight_t weight);
-  void addObjectiveVariables(std::unordered_map<int, weight_t> & bvar_weights);
+  void addObjectiveVariables(const BvarTable & bvars);
   void reset();
   void forbidCurrentSolution();
   void addConstraint(std::vector<int>& core, double bound=1.0, Comparator comp=GTE);
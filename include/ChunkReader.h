@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdio>
+
+// Reads a (possibly compressed) file in chunks. Decompression runs on a
+// separate thread, a bounded number of chunks ahead of the consumer.
+class ChunkReader {
+ public:
+
+  enum Format { Plain, Gzip, Xz, Bzip2 };
+
+  // detect the compression format from the magic bytes of the file
+  static Format detectFormat(const char * filepath);
+
+  // false if support for the format was not compiled in
+  static bool supported(Format format);
+
+  ChunkReader(const char * filepath, Format format);
+  ~ChunkReader();
+
+  bool fail() const { return file == nullptr; }
+
+  // Blocks until the next chunk of decompressed data is available.
+  // The previous contents of chunk are recycled as a buffer.
+  // returns false at end of input
+  bool next(std::vector<char> & chunk);
+
+  // true if decompression stopped on corrupt or unsupported input
+  bool error() const { return failed; }
+
+ private:
+  ChunkReader(const ChunkReader&);
+  void operator=(ChunkReader const&);
+
+  static const size_t chunk_size = 4 << 20;
+  static const unsigned max_chunks = 4;
+
+  void produce();
+  bool readPlain();
+  bool readGzip();
+  bool readXz();
+  bool readBzip2();
+
+  // fill chunks by calling read(dst, n) until it returns 0 (end of
+  // input) or a negative value (error)
+  bool pump(std::function<long(char *, size_t)> read);
+
+  // hand a filled buffer to the consumer, get an empty one back
+  // returns false if the consumer has stopped reading
+  bool push(std::vector<char> & buf);
+
+  FILE * file;
+  Format format;
+
+  std::thread producer;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<std::vector<char>> full;
+  std::vector<std::vector<char>> empty;
+  bool done;
+  bool stopped;
+  bool failed;
+};
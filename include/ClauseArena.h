@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Clauses stored back to back in a single literal array. The literals
+// of clause id are lits[offsets[id]] .. lits[offsets[id+1] - 1].
+// Ids are assigned in insertion order and stay valid; pointers into
+// the arena are invalidated by add and extend.
+class ClauseArena {
+ public:
+  ClauseArena() : offsets(1, 0) { }
+
+  // append a clause, returns its id
+  // (the literals must not point into this arena)
+  unsigned add(const int * begin, const int * end) {
+    lits.insert(lits.end(), begin, end);
+    offsets.push_back(lits.size());
+    return offsets.size() - 2;
+  }
+
+  unsigned add(const std::vector<int> & clause) {
+    return add(clause.data(), clause.data() + clause.size());
+  }
+
+  // append a literal to the most recently added clause
+  void extend(int lit) {
+    lits.push_back(lit);
+    offsets.back()++;
+  }
+
+  unsigned size() const { return offsets.size() - 1; }
+  size_t nLits() const { return lits.size(); }
+
+  unsigned clauseSize(unsigned id) const { return offsets[id + 1] - offsets[id]; }
+  const int * begin(unsigned id) const { return lits.data() + offsets[id]; }
+  const int * end(unsigned id) const { return lits.data() + offsets[id + 1]; }
+
+  std::vector<int> get(unsigned id) const {
+    return std::vector<int>(begin(id), end(id));
+  }
+
+ private:
+  std::vector<int> lits;
+  std::vector<size_t> offsets;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+// The cores found so far, without duplicates or cores that contain
+// another one, with the cores each bvar occurs in.
+//
+// A core is removed by moving the last core into its place, so removing
+// cores changes the order of the others. Fixing or relaxing a bvar only
+// touches the cores it occurs in, and the core moved into their places.
+class CoreDB {
+ public:
+  CoreDB() : n_removed(0), n_subsumed(0) { }
+
+  // Adds core unless some core is a subset of it, and removes the cores
+  // it is a subset of. Returns false if core was not added.
+  bool add(const std::vector<int>& core);
+  // removes bvar b, fixed to false, from its cores
+  void fix(int b);
+  // removes the cores of bvar b, relaxed by the solver
+  void relax(int b);
+
+  const std::vector<std::vector<int>>& cores() const { return core_list; }
+  // number of cores each bvar occurs in, indexed by variable
+  const std::vector<unsigned>& counts() const { return count; }
+  unsigned size() const { return core_list.size(); }
+
+  // cores removed so far, by add or relax
+  unsigned long nRemoved() const { return n_removed; }
+  // cores that were not added by add
+  unsigned long nSubsumed() const { return n_subsumed; }
+
+ private:
+  void grow(int b);
+  void remove(unsigned i);
+
+  std::vector<std::vector<int>> core_list;
+  // indices of the cores of each bvar, count[b] == occurs[b].size()
+  std::vector<std::vector<unsigned>> occurs;
+  std::vector<unsigned> count;
+
+  // state of add: overlap of each core with the one added
+  std::vector<unsigned> overlap;
+  std::vector<unsigned> touched;
+  std::vector<unsigned> evict;
+
+  unsigned long n_removed;
+  unsigned long n_subsumed;
+};
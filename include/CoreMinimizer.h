@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include "MinisatSolver.h"
+#include "BvarTable.h"
+#include "GlobalConfig.h"
+
+class ProblemInstance;
+
+// Minimizes one core with a solver that has the clauses of a problem
+// instance. The algorithms only differ in the subsets of the core they
+// test, the tests are shared:
+// - only the bvars of the core change between tests, all other bvars
+//   stay relaxed, so the tests share a long prefix of assumptions
+// - an unsatisfiable test gives its final conflict, which the
+//   algorithms shrink their candidates to (clause-set refinement)
+// - a satisfiable test may prove members critical, also by model
+//   rotation, and they stay known for every later test
+// The core is replaced by the smallest core found so far when the
+// minimization budget runs out.
+class CoreMinimizer {
+ public:
+  CoreMinimizer(ProblemInstance & instance, MinisatSolver * solver,
+                std::vector<int> & core);
+
+  void destructive();
+  void constructive();
+  void binarySearch();
+  void quickXplain();
+  void progression();
+
+ private:
+  CoreMinimizer(const CoreMinimizer&);
+  void operator=(CoreMinimizer const&);
+
+  enum Result { unsat, sat, unknown };
+
+  // Tests if the clauses of set, members of the core, are unsatisfiable.
+  // subcore gets the final conflict if they are. unknown if the budget
+  // has run out.
+  Result test(const std::vector<int> & set);
+  // After a satisfiable test: c, or else the only member of within the
+  // model falsifies, is critical in within and every core it has, and
+  // so may be others by model rotation.
+  void rotate(const std::vector<int> & within, int c = 0);
+  // keeps the members of lits in the last subcore, in order
+  void refine(std::vector<int> & lits) const;
+  // moves the members of lits known to be critical to mus
+  void moveCritical(std::vector<int> & lits, std::vector<int> & mus) const;
+
+  void quickXplain(std::vector<int> & base, std::vector<int> cands,
+                   std::vector<int> & mus);
+
+  ProblemInstance & instance;
+  MinisatSolver * solver;
+  GlobalConfig & cfg;
+
+  std::vector<int> & core;
+  // the core when minimization started
+  std::vector<int> members;
+  VarFlags critical;
+
+  std::vector<int> subcore;
+  VarFlags in_subcore;
+
+  bool limited;
+  bool out_of_budget;
+  int calls;
+};
@@ -2,14 +2,15 @@
 
 #include <functional>
 #include <vector>
-#include <unordered_map>
 
 #include "Weights.h"
+#include "BvarTable.h"
 
 typedef std::function<void(
     std::vector<int>& out_hs, const std::vector<std::vector<int>>& new_cores,
     const std::vector<std::vector<int>>& cores,
-    const std::unordered_map<int, weight_t>& weights,
-    const std::unordered_map<int, unsigned>& coreClauseCounts)> NonOptHSFunc;
+    const BvarTable& weights,
+    const std::vector<unsigned>& coreClauseCounts)> NonOptHSFunc;
 
-enum MinimizeAlgorithm {rerefute, constructive, binary, destructive, cardinality};
\ No newline at end of file
+enum MinimizeAlgorithm {rerefute, constructive, binary, destructive, cardinality,
+                        quickxplain, progression};
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "BvarTable.h"
+#include "Weights.h"
+
+// Greedy minimum cost hitting set of a growing set of cores.
+//
+// Keeps the cores in CSR form and the cores each bvar occurs in between
+// calls, so a call only adds the cores that are new since the last one.
+// The bvar with the lowest weight per core not yet hit is taken from a
+// heap with lazy deletion: its key only grows as cores get hit, so an
+// entry with an outdated count is pushed back with the current one
+// instead of being updated in place.
+class GreedyHS {
+ public:
+  GreedyHS();
+
+  // out_hs becomes a hitting set of cores, which must be the cores of
+  // the previous call followed by new ones, unless changed is set
+  void solve(std::vector<int>& out_hs, const std::vector<std::vector<int>>& cores,
+             const BvarTable& weights, bool changed);
+
+ private:
+  void clear();
+  void add(const std::vector<int>& core);
+
+  struct Entry {
+    double key;
+    unsigned count;
+    int var;
+    // min-heap on key, ties by var
+    bool operator<(const Entry& e) const {
+      return key > e.key || (key == e.key && var > e.var);
+    }
+  };
+
+  // literals of core i in lits[start[i]..start[i+1]-1]
+  std::vector<unsigned> start;
+  std::vector<int> lits;
+  // cores of each variable, indexed by variable
+  std::vector<std::vector<unsigned>> occurs;
+  // variables that occur in some core
+  std::vector<int> vars;
+
+  // state of a call
+  std::vector<unsigned> count;
+  std::vector<bool> hit;
+  std::vector<Entry> heap;
+};
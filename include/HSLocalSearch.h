@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "BvarTable.h"
+#include "Weights.h"
+
+// Local search for a cheaper hitting set of the cores, as weighted set
+// cover: a bvar is a set of the cores it occurs in. Keeps the number of
+// bvars of the hitting set in each core, so a move only updates the
+// cores of the bvars it adds or removes. The moves are
+// - drop a bvar whose every core has another bvar of the hitting set
+// - swap a bvar for one outside the hitting set that occurs in all the
+//   cores only it hits and weighs less, or as much (a plateau move, after
+//   which the bvar dropped is tabu for a while)
+class HSLocalSearch {
+ public:
+  // Replaces hs, which must hit every core, by a hitting set of at most
+  // its cost, searching for at most time_limit seconds.
+  void improve(std::vector<int>& hs, const std::vector<std::vector<int>>& cores,
+               const BvarTable& weights, double time_limit);
+
+ private:
+  void build(const std::vector<int>& hs, const std::vector<std::vector<int>>& cores);
+  void add(int v);
+  void remove(int v);
+  bool redundant(int v) const;
+  // the cheapest bvar to swap for v, -1 if none
+  int swapFor(int v, const BvarTable& weights, unsigned iteration);
+
+  const std::vector<std::vector<int>>* cores;
+
+  // cores of each variable, indexed by variable
+  std::vector<std::vector<unsigned>> occurs;
+  std::vector<int> vars;
+  // number of bvars of the hitting set in each core
+  std::vector<unsigned> cover;
+  std::vector<char> in_hs;
+  // the first iteration a bvar swapped out may be added again
+  std::vector<unsigned> tabu_until;
+
+  // cores only v hits, for swapFor
+  std::vector<unsigned> unique;
+  std::vector<char> in_unique;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "Weights.h"
+#include "BvarTable.h"
+
+class ProblemInstance;
+
+// Minimum-cost hitting set solver of the implicit hitting set loop.
+// Constraints are clauses over the added variables, and the objective
+// is the total weight of the objective variables set to true.
+class HSSolver {
+ public:
+  enum Status { Failed, Feasible, Optimal };
+  enum Comparator { LTE, GTE };
+
+  virtual ~HSSolver() { }
+
+  virtual void addVariable(int var) = 0;
+  virtual void addObjectiveVariable(int bVar, weight_t weight) = 0;
+  virtual void addObjectiveVariables(const BvarTable & bvars) = 0;
+  // exclude the last hitting set as well as its subsets and supersets
+  virtual void forbidCurrentSolution() = 0;
+  // sum of literals (negative literals count as 1 - var) compared to bound
+  virtual void addConstraint(std::vector<int>& core, double bound=1.0, Comparator comp=GTE) = 0;
+
+  // relaxed (non-optimal) hitting set and a lower bound for the optimum
+  virtual bool LPsolveHS(std::vector<int>& hittingSet, weight_t& weight) = 0;
+  // optimal assignment of the non-objective variables, for --ip
+  virtual bool solveForModel(std::vector<int>& model, weight_t& weight) = 0;
+  virtual Status solveForHS(std::vector<int>& hittingSet, weight_t& weight, ProblemInstance* instance) = 0;
+
+  // whether the bvar equivalence constraints of --equiv-seed help
+  virtual bool wantsEquivSeed() const { return true; }
+
+  virtual void exportModel(std::string file) = 0;
+  virtual void printStats() = 0;
+};
+
+// creates the hitting set solver selected with --hs-solver
+HSSolver * newHSSolver();
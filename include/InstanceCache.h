@@ -0,0 +1,28 @@
+#pragma once
+
+#include "WCNFParser.h"
+
+class VarMapper;
+namespace maxPreprocessor { class PreprocessorInterface; }
+
+// Binary snapshot of an instance after parsing and preprocessing, so
+// that repeated solves of the same file skip both.
+//
+// The file is a fixed header followed by 8-byte aligned arrays and is
+// read from a memory mapping. A cache is only used if its version, the
+// weight type, the preprocessing options and the size and modification
+// time of the input file match the current run.
+
+// wcnf holds the clauses after preprocessing (assumptions = labels).
+// preprocessor is null if the instance was not preprocessed.
+// returns false if the file could not be written
+bool writeInstanceCache(const char * cache_path, const char * wcnf_path,
+                        const WCNFData & wcnf, VarMapper * varmap,
+                        maxPreprocessor::PreprocessorInterface * preprocessor);
+
+// On success, wcnf holds the cached clauses and preprocessor the
+// restored model reconstruction state (null if not preprocessed).
+// returns false if the cache is missing, stale or corrupt
+bool readInstanceCache(const char * cache_path, const char * wcnf_path,
+                       WCNFData & wcnf, VarMapper * varmap,
+                       maxPreprocessor::PreprocessorInterface *& preprocessor);
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "HSSolver.h"
+#include "ClauseArena.h"
+#include "Timer.h"
+#include "Weights.h"
+
+// Exact minimum-cost hitting set solver that needs no external IP solver.
+//
+// Depth-first branch and bound over the constraints (clauses). At each
+// node unit constraints are propagated and the node is pruned with two
+// lower bounds: a greedy LP dual that spreads column weights over the
+// unsatisfied constraints (at least as strong as disjoint cores), and a
+// Lagrangian relaxation whose multipliers are improved by a few
+// subgradient steps per node and carried over between nodes and calls.
+// The Lagrangian rows include a clique cover of the binary constraints,
+// which closes most of the LP gap on vertex cover like problems. Reduced
+// costs fix columns, and rounding the Lagrangian solution gives good
+// solutions early.
+//
+// The search branches on the literals of the unsatisfied constraint with
+// the fewest free literals among those without free negative literals.
+// Once only constraints with a free negative literal remain, leaving the
+// free variables false completes the solution at no cost.
+//
+// Every literal has a bitset of the constraints it satisfies, so that
+// assigning a variable marks its constraints with a few word operations.
+// New constraints only set bits in the bitsets of their own literals, and
+// the previous optimum stays a lower bound for the next call.
+class MCHSSolver : public HSSolver {
+ public:
+  MCHSSolver();
+
+  void addVariable(int var);
+  void addObjectiveVariable(int bVar, weight_t weight);
+  void addObjectiveVariables(const BvarTable & bvars);
+  void forbidCurrentSolution();
+  void addConstraint(std::vector<int>& core, double bound=1.0, Comparator comp=GTE);
+
+  bool LPsolveHS(std::vector<int>& hittingSet, weight_t& weight);
+  bool solveForModel(std::vector<int>& model, weight_t& weight);
+  Status solveForHS(std::vector<int>& hittingSet, weight_t& weight, ProblemInstance* instance);
+
+  // constraints with negative literals make the search much harder
+  // without clause learning, more than they tighten the bound
+  bool wantsEquivSeed() const { return false; }
+
+  // writes the constraints in CPLEX LP format
+  void exportModel(std::string file);
+  void printStats();
+
+  Timer solver_timer;
+  unsigned solver_calls;
+  unsigned lp_calls;
+  uint64_t nodes;
+
+ private:
+  MCHSSolver(const MCHSSolver&);
+  void operator=(MCHSSolver const&);
+
+  typedef std::vector<uint64_t> Bitset;
+
+  // column of var, created with weight 0 if it does not exist
+  unsigned column(int var);
+  // adds a constraint over literals 2 * col + (negative ? 1 : 0)
+  void addClause(const std::vector<int>& lits);
+
+  // size the search state for the current columns and constraints
+  void prepare();
+  void findCliques();
+  // solve until an assignment of cost at most target is found,
+  // or one of cost below cutoff if stop_below_cutoff is set
+  Status solve(weight_t target, bool stop_below_cutoff, weight_t cutoff);
+  void search(Bitset sat, weight_t cost);
+  // unit propagation, returns false on a conflict. pick is the unsatisfied
+  // constraint with the fewest free literals, all of them positive (-1 if
+  // none, then setting the free variables false satisfies everything)
+  bool propagate(Bitset & sat, weight_t & cost, int & pick);
+  void branch(const Bitset & sat, weight_t cost, unsigned k);
+  void record(const std::vector<signed char> & assignment, weight_t cost);
+  void assign(int lit, Bitset & sat, weight_t & cost);
+  void undo(size_t trail_size);
+
+  // bounds stop early once they reach limit
+  weight_t lowerBound(const Bitset & sat, weight_t limit);
+  weight_t lagrangianBound(const Bitset & sat, weight_t limit, unsigned iters);
+  // largest weight below a bound computed in floating point
+  weight_t safeBound(double bound) const;
+  // fixes columns by reduced cost after a greedy bound of lb and the
+  // last Lagrangian bound, returns true if any were fixed
+  bool fixByReducedCost(Bitset & sat, weight_t & cost, weight_t lb);
+  // rounds the last Lagrangian solution into a solution of the node
+  void roundLagrangian(weight_t cost);
+  void setHeuristic(unsigned c, signed char v);
+
+  // weight of a free column left over by the last lowerBound
+  weight_t reducedCost(unsigned c) const { return resid_stamp[c] == stamp ? resid[c] : col_weight[c]; }
+  weight_t litCost(int lit) const { return (lit & 1) ? 0 : col_weight[lit >> 1]; }
+  bool isSat(const Bitset & sat, unsigned k) const { return (sat[k >> 6] >> (k & 63)) & 1; }
+  double & rowMult(unsigned id) { return id < cons.size() ? mult[id] : clique_mult[id - cons.size()]; }
+
+  // columns
+  std::vector<int> var_col;
+  std::vector<int> col_var;
+  std::vector<weight_t> col_weight;
+  std::vector<bool> col_obj;
+
+  ClauseArena cons;
+  // constraints satisfied by each literal
+  std::vector<Bitset> occ;
+
+  // search state, val is -1 for unassigned columns
+  std::vector<signed char> val;
+  std::vector<int> trail;
+  bool stop;
+  weight_t target_cost;
+  bool stop_below_cutoff;
+  weight_t cutoff_cost;
+
+  // greedy bound
+  std::vector<unsigned> cons_order;
+  std::vector<weight_t> resid;
+  std::vector<unsigned> resid_stamp;
+  unsigned stamp;
+
+  // clique cover of the binary constraints, as positive literals
+  ClauseArena cliques;
+  unsigned clique_edges;
+
+  // Lagrange multipliers of the constraints and cliques
+  std::vector<double> mult;
+  std::vector<double> clique_mult;
+  unsigned lag_iters;
+  // rows of the node: the first n_lag_cons are constraints and the rest
+  // cliques, active holds their ids with cliques offset by cons.size()
+  std::vector<unsigned> active;
+  unsigned n_lag_cons;
+  std::vector<int> lag_rhs;
+  std::vector<unsigned> lag_start;
+  std::vector<int> lag_lits;
+  std::vector<unsigned> free_cols;
+  std::vector<double> subgrad;
+  std::vector<double> lag_rc;
+  // best Lagrangian bound of the node and its reduced costs
+  double lag_bound;
+  std::vector<double> lag_best_rc;
+
+  // rounding heuristic, rows are indices to active
+  std::vector<signed char> heur_val;
+  std::vector<unsigned> heur_count;
+  std::vector<unsigned> heur_occ_start;
+  std::vector<unsigned> heur_occ;
+  std::vector<unsigned> heur_fill;
+  std::vector<unsigned> heur_cols;
+
+  // best assignment of the last call
+  std::vector<signed char> best_val;
+  weight_t best_cost;
+  bool solutionExists;
+  // optimum of the last call, a lower bound as constraints are only added
+  weight_t last_opt;
+};
@@ -14,6 +14,7 @@
 #include "Util.h"
 #include "GlobalConfig.h"
 #include "Weights.h"
+#include "BvarTable.h"
 #include "Timer.h"
 #include "minisat/core/Solver.h"
 
@@ -44,9 +45,26 @@ class MinisatSolver {
   Minisat::lbool upol;
   Minisat::Solver* minisat;
   static const int deactivateMask = ~1;
+  // assumptions other than the bvars, assumed before them
   Minisat::vec<Minisat::Lit> assumptions;
+  bool assume_bvars;
+  // The bvar assumptions are kept between calls in the order given to
+  // Minisat. Bvars that changed polarity since the last call move to the
+  // end before the next one, so that consecutive calls share a long
+  // prefix of assumptions.
   Minisat::vec<Minisat::Lit> bvar_assumptions;
-  std::unordered_map<int, int> var_assumptionIdx;
+  // position of each bvar in bvar_assumptions, -1 for other variables
+  std::vector<int> var_assumptionIdx;
+  // positions that changed polarity since the last call, from first_changed
+  std::vector<char> changed;
+  int first_changed;
+  // the bvars given to relaxOnly or activateOnly, while the others have
+  // not changed polarity since
+  std::vector<int> only_bvars;
+  enum { none, relax_only, activate_only } only_mode;
+  std::vector<char> only_mark;
+  // assumptions followed by bvar_assumptions, if there are both
+  Minisat::vec<Minisat::Lit> all_assumptions;
   clock_t initTime, start, end;
   GlobalConfig &cfg;
 
@@ -56,6 +74,32 @@ class MinisatSolver {
   Minisat::lbool solveLimited();
   void getConflicts(std::vector<std::vector<int>>& out_cores);
 
+  const Minisat::vec<Minisat::Lit> & currentAssumptions();
+  void reorderBvarAssumptions();
+  void setOnly(const std::vector<int>& bvars, bool relax);
+
+  int bvarIdx(int bvar) const {
+    assert(bvar > 0);
+    assert(unsigned(bvar) < var_assumptionIdx.size() && var_assumptionIdx[bvar] >= 0);
+    return var_assumptionIdx[bvar];
+  }
+
+  // relax (deactivate) or activate the clause of the bvar at position i
+  void relaxAt(int i, bool relax) {
+    Minisat::Lit & l = bvar_assumptions[i];
+    if (Minisat::sign(l) != relax) return;
+    if (relax) l.x &= deactivateMask;
+    else l.x |= 1;
+    if (!changed[i]) {
+      changed[i] = 1;
+      first_changed = std::min(first_changed, i);
+    }
+  }
+
+  // moving average of the conflicts per call
+  double avg_conflicts;
+  void countConflicts(uint64_t n) { avg_conflicts += (n - avg_conflicts) / 8; }
+
  public:
 
   unsigned solver_calls;
@@ -68,6 +112,9 @@ class MinisatSolver {
 
   bool hasModel;
 
+  // conflicts of a typical recent call
+  double recentConflicts() const { return avg_conflicts; }
+
   MinisatSolver();
   ~MinisatSolver() { delete minisat; }
 
@@ -82,14 +129,25 @@ class MinisatSolver {
   int newVar();
 
   bool addConstraint(std::vector<int>& constr);
+  bool addConstraint(const int * begin, const int * end);
 
   void getModel(std::vector<bool>& model);
-  weight_t getModelWeight(std::unordered_map<int, weight_t>& bvar_weights);
+  weight_t getModelWeight(const BvarTable& bvars);
 
   void deleteLearnts() { minisat->deleteLearnts(); }
   void invertActivity() { minisat->invertVarActivity(); }
   void randomizeActivity() { minisat->randomizeVarActivity(); }
   void setRandomSeed(double seed) { minisat->random_seed = seed; }
+  void setRandomFreq(double freq) { minisat->random_var_freq = freq; }
+  void setVarDecay(double decay) { minisat->var_decay = decay; }
+  void setPhaseSaving(int mode) { minisat->phase_saving = mode; }
+  void setLubyRestart(bool luby) { minisat->luby_restart = luby; }
+  // only affects variables added afterwards
+  void setRandomInitActivity(bool rnd) { minisat->rnd_init_act = rnd; }
+
+  // makes a running solve return without a core or a model,
+  // may be called from another thread
+  void interrupt() { minisat->interrupt(); }
 
   void printStats(const char* solver_name);
 
@@ -122,54 +180,70 @@ class MinisatSolver {
   // Activate every clause by setting all b-variables to false
   // (set least significant bit to 1)
   void unsetBvars() {
-    for (int i = 0; i < bvar_assumptions.size(); i++) bvar_assumptions[i].x |= 1;
+    only_mode = none;
+    for (int i = 0; i < bvar_assumptions.size(); i++) relaxAt(i, false);
   }
 
   // Deactivate every clause by setting all b-variables to true
   // (set least significant bit to 0)
   void setBvars() {
-    for (int i = 0; i < bvar_assumptions.size(); i++)
-      bvar_assumptions[i].x &= deactivateMask;
+    only_mode = none;
+    for (int i = 0; i < bvar_assumptions.size(); i++) relaxAt(i, true);
   }
 
   // activate a clause by its bvar
   void unsetBvar(int bLit) {
-    assert(bLit > 0);
-    assert(var_assumptionIdx.count(bLit));
-    bvar_assumptions[var_assumptionIdx[bLit]].x |= 1;
+    only_mode = none;
+    relaxAt(bvarIdx(bLit), false);
   }
 
   // deactivate a clause by its bvar
   void setBvar(int bLit) {
-    assert(bLit > 0);
-    assert(var_assumptionIdx.count(bLit));
-    bvar_assumptions[var_assumptionIdx[bLit]].x &= deactivateMask;
+    only_mode = none;
+    relaxAt(bvarIdx(bLit), true);
   }
 
+  // Deactivate the clauses of bvars (a hitting set) and activate all
+  // others, or the other way around. Repeated calls of either only
+  // update the bvars of the previous call and the new ones.
+  void relaxOnly(const std::vector<int>& bvars) { setOnly(bvars, true); }
+  void activateOnly(const std::vector<int>& bvars) { setOnly(bvars, false); }
+
   void clearAssumptions() {
     assumptions.clear();
+    assume_bvars = false;
   }
 
   void assumeLit(int l) {
     assumptions.push(int2lit(l));
   }
 
+  // the bvar assumptions as set when solving
   void assumeBvars() {
-    for (auto l : bvar_assumptions)
-      assumptions.push(l);
+    assume_bvars = true;
   }
 
   void addBvarAssumption(int bvar) {
+    if (unsigned(bvar) >= var_assumptionIdx.size())
+      var_assumptionIdx.resize(bvar + 1, -1);
     var_assumptionIdx[bvar] = bvar_assumptions.size();
     bvar_assumptions.push(Minisat::mkLit(bvar));
+    changed.push_back(0);
   }
 
   void removeBvarAssumption(int bVar) {
+    int i = bvarIdx(bVar);
     int tailIdx = bvar_assumptions.size() - 1;
-    var_assumptionIdx[var(bvar_assumptions[tailIdx])] = var_assumptionIdx[bVar];
-    bvar_assumptions[var_assumptionIdx[bVar]] = bvar_assumptions[tailIdx];
-    var_assumptionIdx.erase(bVar);
+    // the tail bvar takes its position
+    if (i < tailIdx) {
+      bvar_assumptions[i] = bvar_assumptions[tailIdx];
+      var_assumptionIdx[var(bvar_assumptions[i])] = i;
+      changed[i] = 1;
+      first_changed = std::min(first_changed, i);
+    }
+    var_assumptionIdx[bVar] = -1;
     bvar_assumptions.pop();
+    changed.pop_back();
   }
 
   int nVars() { return minisat->nVars(); }
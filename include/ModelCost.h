@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "ClauseArena.h"
+#include "BvarTable.h"
+#include "Weights.h"
+
+// Incremental evaluation of the cost of SAT solver models.
+//
+// Keeps the number of satisfied literals of each soft clause and the
+// number of unsatisfied clauses of each bvar for the previously evaluated
+// model. A new model is evaluated by walking the occurrence lists of the
+// variables whose value changed, so the clause work per SAT call is
+// proportional to the difference between consecutive models.
+//
+// The cost is that of ProblemInstance::tightenModel: the weight of every
+// bvar that is true and has an unsatisfied clause.
+class ModelCost {
+ public:
+  // clauses are the soft clauses without bvars, ids as in bvars
+  ModelCost(const ClauseArena & clauses, const BvarTable & bvars);
+
+  // must be called when clauses or bvars change
+  void invalidate() { built = false; }
+
+  // returns false if the cost can not be evaluated incrementally
+  // (some bvar clause contains a bvar, so tightening is order dependent)
+  bool evaluate(const std::vector<bool> & model, weight_t & cost);
+
+ private:
+  void build();
+  void flip(int var, bool value);
+  void setLit(int lit, bool value);
+
+  const ClauseArena & clauses;
+  const BvarTable & bvars;
+
+  bool built;
+  bool exact;
+
+  // clause ids of literal l in occ[occ_start[l]..occ_start[l+1]-1],
+  // where l = 2 * var + (negative ? 1 : 0)
+  std::vector<unsigned> occ_start;
+  std::vector<unsigned> occ;
+  // bvar index of each clause, -1 for clauses of removed bvars
+  std::vector<int> owner;
+
+  // state for the last evaluated model
+  std::vector<bool> value;
+  std::vector<unsigned> sat_count;
+  std::vector<unsigned> unsat_clauses;
+  weight_t cost;
+};
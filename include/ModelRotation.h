@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <cstdlib>
+
+#include "ClauseArena.h"
+#include "BvarTable.h"
+
+// Model rotation for core minimization. A model of the clauses with the
+// bvars of core \ {c} false falsifies the soft clauses of c. Flipping a
+// literal of such a clause may give a model that falsifies the soft
+// clauses of exactly one other member d of the core instead, which
+// proves d critical without a SAT call. Recursive rotation goes on to
+// rotate the model found for d.
+//
+// Occurrence lists are only built on the first sync. Other calls only
+// read them and may run in several threads between syncs.
+class ModelRotation {
+ public:
+  ModelRotation(const ClauseArena & clauses, const BvarTable & bvars);
+
+  // index clauses added since the last call
+  void sync();
+
+  // The member c of core such that model, with the bvars of core false,
+  // only falsifies clauses that relaxing c satisfies, 0 if there is none.
+  // c is then critical.
+  int falsified(std::vector<bool> model, const std::vector<int> & core) const;
+
+  // model must satisfy the clauses with the bvars of core \ {c} false,
+  // which they are set to, as falsified also does. Appends the members
+  // of core proved critical, other than c, to critical.
+  void rotate(std::vector<bool> model, int c, const std::vector<int> & core,
+              std::vector<int> & critical, bool recursive) const;
+
+ private:
+  ModelRotation(const ModelRotation&);
+  void operator=(ModelRotation const&);
+
+  static unsigned index(int lit) { return 2 * abs(lit) + (lit < 0); }
+  static bool value(const std::vector<bool> & model, int lit) {
+    return model[abs(lit)] == (lit > 0);
+  }
+  // model is restored before returning, found gets the members proved critical
+  void rotateFrom(std::vector<bool> & model, int c, const VarFlags & in_core,
+                  std::vector<int> & found, bool recursive) const;
+  bool satisfied(const std::vector<bool> & model, unsigned id) const;
+  // false unless every clause of ids falsified by model is a soft clause
+  // of the same member d of the core, d is 0 while none has been found
+  bool relaxable(const std::vector<bool> & model, const VarFlags & in_core,
+                 const std::vector<unsigned> & ids, int & d) const;
+
+  const ClauseArena & clauses;
+  const BvarTable & bvars;
+  // clause ids by literal index
+  std::vector<std::vector<unsigned>> occurs;
+  unsigned n_clauses;
+};
@@ -10,20 +10,21 @@ namespace NonoptHS {
 void common(std::vector<int>& out_hs,
             const std::vector<std::vector<int>>& new_cores,
             const std::vector<std::vector<int>>&,
-            const std::unordered_map<int, weight_t>&,
-            const std::unordered_map<int, unsigned>& coreClauseCounts);
+            const BvarTable&,
+            const std::vector<unsigned>& coreClauseCounts);
 
-void greedy(std::vector<int>& out_hs,
-            const std::vector<std::vector<int>>& new_cores,
-            const std::vector<std::vector<int>>&,
-            const std::unordered_map<int, weight_t>&,
-            const std::unordered_map<int, unsigned>& coreClauseCounts);
+// Greedy minimum cost hitting set of all cores. Each function returned
+// keeps the cores between calls, see GreedyHS.
+NonOptHSFunc greedy();
+
+// must be called when cores are removed or changed, rather than added
+void coresChanged();
 
 NonOptHSFunc frac(double fracSize);
 
 void disjoint(std::vector<int>& out_hs,
               const std::vector<std::vector<int>>& new_cores,
               const std::vector<std::vector<int>>&,
-              const std::unordered_map<int, weight_t>&,
-              const std::unordered_map<int, unsigned>& coreClauseCounts);
+              const BvarTable&,
+              const std::vector<unsigned>& coreClauseCounts);
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <set>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "MinisatSolver.h"
+#include "Defines.h"
+
+class ProblemInstance;
+
+// Helper threads for --portfolio. The main thread keeps the hitting set
+// solver and publishes each optimal hitting set. Every worker extends the
+// latest one into a non-optimal hitting set with its own Minisat instance,
+// diversified by seed, search parameters and minimization algorithm, and
+// minimizes the cores it finds with the same solver.
+//
+// Cores go to a lock-free stack that the main thread empties between
+// iterations. Models are offered to the instance (offerModel).
+//
+// Workers only read the clauses and bvars of the instance, which must not
+// change while they run.
+class Portfolio {
+ public:
+  // starts n_workers threads
+  Portfolio(ProblemInstance & instance, unsigned n_workers);
+  // stops and joins the workers
+  ~Portfolio();
+
+  // hands the workers a new hitting set to extend
+  void publish(const std::vector<int> & hs);
+  // moves cores found since the last call to out, skipping duplicates
+  void collectCores(std::vector<std::vector<int>> & out);
+
+ private:
+  Portfolio(const Portfolio&);
+  void operator=(Portfolio const&);
+
+  struct Worker {
+    unsigned id;
+    MinisatSolver * solver;
+    MinimizeAlgorithm minAlg;
+    // guards interrupting the solver only while it looks for a core
+    std::mutex interrupt_mutex;
+    bool interruptible;
+    std::thread thread;
+  };
+
+  struct CoreNode {
+    std::vector<int> core;
+    CoreNode * next;
+  };
+
+  void configure(Worker & w);
+  void run(Worker & w);
+  // false if stopped
+  bool findCore(Worker & w, std::vector<int> & core);
+  void pushCore(std::vector<int> & core);
+  void stop();
+
+  ProblemInstance & instance;
+  std::vector<Worker *> workers;
+  std::atomic<bool> stopping;
+
+  // latest published hitting set and its version
+  std::mutex hs_mutex;
+  std::condition_variable hs_changed;
+  std::vector<int> hs;
+  unsigned hs_version;
+
+  std::atomic<CoreNode *> core_pool;
+  // cores collected so far, sorted
+  std::set<std::vector<int>> collected;
+};
@@ -4,15 +4,23 @@
 #include <vector>
 #include <string>
 #include <iosfwd>
+#include <mutex>
+#include <atomic>
 
 #include "MinisatSolver.h"
-#include "CPLEXSolver.h"
+#include "HSSolver.h"
 #include "GlobalConfig.h"
 #include "Util.h"
 #include "Weights.h"
+#include "ClauseArena.h"
+#include "BvarTable.h"
+#include "ModelCost.h"
+#include "ModelRotation.h"
 #include "preprocessorinterface.hpp"
 #include "Timer.h"
 #include "Defines.h"
+#include "WCNFParser.h"
+#include "VarMapper.h"
 
 class ProblemInstance {
  public:
@@ -20,8 +28,18 @@ class ProblemInstance {
   ProblemInstance(unsigned nClauses, weight_t top, weight_t* weights,
                   int* raw_clauses, std::ostream& out);
   ProblemInstance(std::istream & wcnf_in, std::ostream& out);
+  // releases the clause arrays of wcnf after loading
+  ProblemInstance(WCNFData & wcnf, std::ostream& out);
   ~ProblemInstance();
 
+  // Preprocess and add the clauses of wcnf, releasing its clause arrays.
+  // Writes the instance cache if cfg.instanceCache and filename are set.
+  void load(WCNFData & wcnf);
+
+  // Load from an instance cache of filename instead of parsing it.
+  // returns false if the cache is missing or stale
+  bool loadCache(const std::string & cache_path);
+
   std::vector<int> reconstruct(std::vector<int> & model);
 
   Timer parse_timer;
@@ -33,21 +51,25 @@ class ProblemInstance {
 
   MinisatSolver* sat_solver;
   MinisatSolver* muser;
-  CPLEXSolver* mip_solver;
+  HSSolver* mip_solver;
 
   std::vector<int> fixQueue;
   std::vector<int> relaxQueue;
 
-  std::unordered_map<int, bool> flippedInternalVarPolarity;
-  std::unordered_map<int, weight_t> bvar_weights;
-
-  std::vector<std::vector<int>*> clauses;
-  std::vector<std::vector<int>*> hard_clauses;
-  std::vector<std::vector<int>*> soft_clauses;
-  // map bvariable to soft clause
-  std::unordered_map<unsigned, std::vector<std::vector<int>*> > bvar_soft_clauses;
-  std::unordered_map<unsigned, int> bvar_clause_ct;
-  std::unordered_map<unsigned, bool> isOriginalVariable;
+  VarFlags flippedInternalVarPolarity;
+  // bvars with their weights and soft clause ids in bvar_clauses
+  BvarTable bvars;
+
+  // all clauses given to the SAT solver, soft clauses with their bvars
+  ClauseArena clauses;
+  // ids in clauses
+  std::vector<unsigned> hard_clauses;
+  std::vector<unsigned> soft_clauses;
+  // soft clauses without their bvars
+  ClauseArena bvar_clauses;
+  VarFlags isOriginalVariable;
+  // proves core members critical from minimizer models
+  ModelRotation rotation;
 
   void forbidCurrentMIPSol();
   void forbidCurrentModel();
@@ -64,9 +86,11 @@ class ProblemInstance {
 
   void getSolution(std::vector<int>& out_solution);
   void getSolution(std::vector<int>& out_solution, MinisatSolver * solver);
+  void getSolution(std::vector<int>& out_solution, std::vector<bool> model);
   weight_t tightenModel(std::vector<bool>& model);
   weight_t getSolutionWeight(MinisatSolver * solver);
-  bool bVarSatisfied(std::vector<bool> & model, int b);
+  // i is a bvar index
+  bool bVarSatisfied(std::vector<bool> & model, unsigned i);
 
   weight_t totalWeight();
 
@@ -74,7 +98,10 @@ class ProblemInstance {
 
   void attach(MinisatSolver * solver);
   void attachMuser(MinisatSolver * solver);
-  void attach(CPLEXSolver * solver);
+  void attach(HSSolver * solver);
+  // adds the variables, bvar assumptions and clauses to solver,
+  // returns false if the clauses are unsatisfiable
+  bool loadClauses(MinisatSolver * solver);
 
   void toLCNF(std::ostream& out);
 
@@ -82,17 +109,39 @@ class ProblemInstance {
   std::string filename;
   bool isUNSAT;
 
-  void updateBvarMap(int bvar, std::vector<int>* sc);
+  void updateBvarMap(int bvar, unsigned clause_id);
   void addBvar(int var, weight_t weight);
 
   void reduceCore(std::vector<int>& core, MinimizeAlgorithm alg);
+  // minimizes with solver, which must have the clauses of the instance
+  void reduceCore(std::vector<int>& core, MinimizeAlgorithm alg, MinisatSolver * solver);
+
+  // sort bvars in order of descending weight
+  void sortByWeight(std::vector<int>& core);
+  // sets the resource budgets for minimizing one core with solver,
+  // false if minimization is not limited
+  bool setMinimizeBudget(MinisatSolver * solver);
 
   void updateUB(weight_t);
   void updateUB(weight_t, MinisatSolver * solver);
+  void updateUB(weight_t, const std::vector<bool> & model);
   void updateLB(weight_t);
+  // forget the UB and its solution after the instance changes
+  void resetUB();
+
+  // Thread-safe UB candidate from a solver other than sat_solver and
+  // muser, such as one used by another thread. The best offered model
+  // becomes the UB once the main thread calls collectOfferedModel.
+  void offerModel(MinisatSolver * solver);
+  void collectOfferedModel();
+  // updates or offers the UB from a model found while minimizing
+  void minimizerModel(MinisatSolver * solver);
 
   void printSolution(std::ostream & model_out);
 
+  // translates model output back to the input's variable ids (optional)
+  VarMapper * varmap;
+
   weight_t LB;
   weight_t UB;
   std::vector<int> UB_solution;
@@ -104,10 +153,22 @@ class ProblemInstance {
 
   GlobalConfig &cfg;
 
+  void build(WCNFData & wcnf);
+
+  // incremental cost of solver models for getSolutionWeight
+  ModelCost cost_eval;
+
+  // best model from offerModel
+  std::mutex offered_mutex;
+  std::atomic<weight_t> offered_UB;
+  std::vector<bool> offered_model;
+
+  // appends members of core proved critical by model rotation
+  void rotateModel(MinisatSolver * solver, const std::vector<int>& core,
+                   std::vector<int>& critical, int c = 0);
+
   void reRefuteCore(MinisatSolver * solver, std::vector<int>& core);
-  void destructiveMinimize(MinisatSolver * solver, std::vector<int>& core);
-  void constructiveMinimize(MinisatSolver * solver, std::vector<int>& core);
-  void binarySearchMinimize(MinisatSolver * solver, std::vector<int>& core);
+  // the other algorithms are in CoreMinimizer
   void cardinalityMinimize(MinisatSolver * solver, std::vector<int>& core);
 
   std::vector<int> branchVars;
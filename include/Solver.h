@@ -7,9 +7,13 @@
 #include "ProblemInstance.h"
 #include "Util.h"
 #include "GlobalConfig.h"
+#include "CoreDB.h"
+#include "HSLocalSearch.h"
 #include "MinisatSolver.h"
 #include "Weights.h"
 
+class SolverPool;
+
 class Solver {
  public:
   Solver(ProblemInstance& instance, std::ostream & out);
@@ -19,6 +23,11 @@ class Solver {
   bool getCores(std::vector<int>& hs, std::vector<std::vector<int>>& cores);
   void setHSAssumptions(std::vector<int>& hs);
   void findGreedyHittingSet(std::vector<int>& hs);
+  int findNonoptCoresInParallel(SolverPool & pool, std::vector<int>& hs,
+                                std::vector<std::vector<int>>& new_cores);
+  void nonoptBatch(unsigned n, std::vector<int>& hs,
+                   const std::vector<std::vector<int>>& new_cores,
+                   std::vector<std::vector<int>>& batch);
 
   void solve();
   void printStats();
@@ -32,27 +41,43 @@ class Solver {
   bool hardClausesSatisfiable();
   void reset();
   void processCore(std::vector<int>& core);
+  void stratify();
+  void nextLevel();
+  void harden();
 
   // variables for timing
   Timer disjoint_timer;
   Timer nonopt_timer;
 
   std::vector<unsigned> coreSizes;
-  std::unordered_map<int, unsigned> coreClauseCounts;
 
   GlobalConfig &cfg;
   ProblemInstance &instance;
   bool newInstance;
 
-  // level weight partitioning
+  // level weight partitioning for --stratify: (weight, bvar) pairs of
+  // each level, heaviest first, levels[0] the lightest level. The bvars
+  // of the levels below current_level are not assumed.
   int current_level;
   std::vector<std::vector<std::pair<weight_t, int>>> levels;
+  // bvars in some constraint of the hitting set solver
+  VarFlags in_hs_solver;
+  // the bvars relaxed by setHSAssumptions
+  std::vector<int> relaxed;
 
   // statistics
   int nSolutions;
-  unsigned nNonoptCores, nEquivConstraints, nDisjointCores;
+  unsigned nNonoptCores, nEquivConstraints, nDisjointCores, nPortfolioCores, nHardened;
+
+  // solvers for --nonopt-threads and --minimize-threads, during solveMaxHS
+  SolverPool * pool;
+  // the other strategies of nonoptBatch, kept for the cores of greedy
+  std::vector<NonOptHSFunc> batch_strategies;
+  // --nonopt-ls-time
+  HSLocalSearch local_search;
 
-  std::vector<std::vector<int> > cores;
+  // the cores for the non-optimal hitting sets
+  CoreDB core_db;
 
   std::ostream & out;
 };
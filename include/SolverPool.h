@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include "MinisatSolver.h"
+#include "Defines.h"
+
+class ProblemInstance;
+
+// Minisat instances with the clauses of a problem instance, used to
+// refute several hitting sets (--nonopt-threads) or minimize several
+// cores (--minimize-threads) at the same time. Hard clauses and hardened
+// bvars are synced before each call, new bvars are not.
+class SolverPool {
+ public:
+  SolverPool(ProblemInstance & instance, unsigned size);
+  ~SolverPool();
+
+  unsigned size() const { return solvers.size(); }
+
+  // Refutes hitting_sets[i] with solver i, each in its own thread.
+  // cores[i] is the minimized core, or empty if hitting_sets[i] was
+  // satisfiable, in which case the model is offered to the instance.
+  void refute(const std::vector<std::vector<int>> & hitting_sets,
+              std::vector<std::vector<int>> & cores);
+  // Minimizes cores in place with up to n_threads solvers. Models found
+  // meanwhile are offered to the instance. A single core is minimized
+  // destructively by all of them, testing several removals at a time.
+  void minimize(std::vector<std::vector<int>> & cores, unsigned n_threads);
+
+ private:
+  SolverPool(const SolverPool&);
+  void operator=(SolverPool const&);
+
+  void sync();
+  void refuteWith(unsigned i, const std::vector<int> & hs, std::vector<int> & core);
+  // re-refutes and minimizes core with solver i as configured
+  void reduce(unsigned i, std::vector<int> & core);
+  // destructive minimization of one core with n_threads solvers
+  void destructiveMinimize(std::vector<int> & core, unsigned n_threads);
+
+  ProblemInstance & instance;
+  std::vector<MinisatSolver *> solvers;
+  MinimizeAlgorithm minAlg;
+  // clauses of the instance in the solvers
+  unsigned n_clauses;
+  // bvars assumed by the solvers
+  std::vector<int> bvar_list;
+};
@@ -1,23 +1,52 @@
 #pragma once
 
-#include <unordered_map>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
 #include <iosfwd>
 
+// Renumbers the variables of an instance to 1..n in order of first
+// occurrence, so that unused variable ids do not take up solver memory.
 class VarMapper {
 
 public:
 
- bool partial;
- bool weighted;
- int n_vars, n_clauses;
+ VarMapper() : n_vars(0), n_mapped(0), inv_var_map(1, 0) { }
 
- void map(std::istream & in, std::ostream & out);
+ int n_vars;
+
+ // internal literal for an original literal, assigning a new internal
+ // variable on first occurrence
+ int mapLit(int l) {
+  unsigned v = abs(l);
+  if (v >= var_map.size()) var_map.resize(std::max<size_t>(2 * var_map.size(), v + 1), 0);
+  int & mv = var_map[v];
+  if (mv == 0) {
+   mv = ++n_mapped;
+   inv_var_map.push_back(v);
+  }
+  return l < 0 ? -mv : mv;
+ }
+
+ // map variables that already occur in clauses, drop the others
+ void mapExisting(std::vector<int> & lits);
+
+ int nMapped() const { return n_mapped; }
+
+ // print a model over internal variables as a "v" line over all
+ // original variables 1..n_vars
+ void printModel(const std::vector<int> & model, std::ostream & out);
+
+ // internal -> original variable table, for saving the mapping
+ const std::vector<int> & inverse() const { return inv_var_map; }
+
+ // restore a mapping saved with inverse()
+ void setInverse(const std::vector<int> & inv);
 
- void unmap(std::istream & in, std::ostream & out);
- 
 private:
 
- std::unordered_map<unsigned, unsigned> var_map;
- std::unordered_map<unsigned, unsigned> inv_var_map;
+ int n_mapped;
+ std::vector<int> var_map;      // original -> internal (0 = unused)
+ std::vector<int> inv_var_map;  // internal -> original
 
 };
@@ -1,11 +1,52 @@
 #pragma once
 
 #include <vector>
+#include <cstddef>
 #include <iosfwd>
 
 #include "Weights.h"
 
-void parseWCNF(std::istream & wcnf_in, std::vector<weight_t>& out_weights,
-               std::vector<int>& out_branchVars, weight_t& out_top,
-               std::vector<std::vector<int> >& out_clauses,
-               std::vector<int>& assumptions, int& n_vars);
\ No newline at end of file
+class VarMapper;
+
+// Clauses of a parsed instance in flat form:
+// the literals of clause i are lits[offsets[i]] .. lits[offsets[i+1] - 1]
+struct WCNFData {
+  WCNFData() : top(WEIGHT_MAX), n_vars(0), weighted(true) { offsets.push_back(0); }
+
+  std::vector<int> lits;
+  std::vector<size_t> offsets;
+  std::vector<weight_t> weights;
+
+  std::vector<int> branchVars;
+  std::vector<int> assumptions;
+
+  weight_t top;
+  int n_vars;
+  bool weighted;
+
+  unsigned nClauses() const { return offsets.size() - 1; }
+  unsigned clauseSize(unsigned i) const { return offsets[i + 1] - offsets[i]; }
+  int * clauseBegin(unsigned i) { return lits.data() + offsets[i]; }
+  int * clauseEnd(unsigned i) { return lits.data() + offsets[i + 1]; }
+};
+
+// Both the classic format ("p wcnf" header, hard clauses weighted top)
+// and the headerless 2022+ format (hard clauses prefixed by 'h') are
+// accepted. For the latter, top is set to the sum of soft weights + 1.
+//
+// If a VarMapper is given, variables are renumbered while parsing
+// and out.n_vars is the number of renumbered variables.
+
+// parse wcnf text in [begin, end)
+void parseWCNF(const char * begin, const char * end, WCNFData & out,
+               VarMapper * varmap = nullptr);
+
+// parse the stream in chunks
+void parseWCNF(std::istream & wcnf_in, WCNFData & out,
+               VarMapper * varmap = nullptr);
+
+// memory-map the file and parse it, gzip/xz/bzip2 files are
+// decompressed on the fly
+// returns false if the file could not be opened
+bool parseWCNFFile(const char * filepath, WCNFData & out,
+                   VarMapper * varmap = nullptr);
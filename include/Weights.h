@@ -13,4 +13,12 @@ typedef double weight_t;
 typedef uint64_t weight_t;
 #define WEIGHT_MAX INT64_MAX
 #define WGT_FMT PRId64
-#endif
\ No newline at end of file
+#endif
+
+// sum += w, unless the sum would reach WEIGHT_MAX
+// returns false on overflow
+inline bool addWeight(weight_t & sum, weight_t w) {
+  if (w >= weight_t(WEIGHT_MAX) || sum >= weight_t(WEIGHT_MAX) - w) return false;
+  sum += w;
+  return true;
+}
@@ -121,7 +121,7 @@ void CPLEXSolver::addObjectiveVariable(int bVar, weight_t weight) {
 
 // adds variables to the cplex instance and sets the objective function to
 // minimize weight
-void CPLEXSolver::addObjectiveVariables(std::unordered_map<int, weight_t> & bvar_weights) {
+void CPLEXSolver::addObjectiveVariables(const BvarTable & bvars) {
   if (objFuncAttached) {
     model.remove(objective);
     objFuncAttached = false;
@@ -131,7 +131,7 @@ void CPLEXSolver::addObjectiveVariables(std::unordered_map<int, weight_t> & bvar
 
   weight_t total_w = 0;
 
-  for (auto b_w : bvar_weights) {
+  for (auto b_w : bvars) {
     objExpr += long(b_w.second) * newObjVar(b_w.first, b_w.second);
     total_w += b_w.second;
   }
@@ -0,0 +1,251 @@
+#include <cstring>  // memcmp, memset
+#include <unistd.h> // dup
+#include <sys/stat.h>
+#include <zlib.h>
+
+#ifdef USE_LZMA
+#include <lzma.h>
+#endif
+#ifdef USE_BZIP2
+#include <bzlib.h>
+#endif
+
+#include "ChunkReader.h"
+
+using namespace std;
+
+ChunkReader::Format ChunkReader::detectFormat(const char * filepath) {
+  // sniffing would consume the input of pipes
+  struct stat st;
+  if (stat(filepath, &st) != 0 || !S_ISREG(st.st_mode)) return Plain;
+
+  unsigned char magic[6] = {0};
+  FILE * f = fopen(filepath, "rb");
+  if (!f) return Plain;
+  size_t n = fread(magic, 1, sizeof(magic), f);
+  fclose(f);
+
+  if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+    return Gzip;
+  if (n >= 6 && !memcmp(magic, "\xfd" "7zXZ\0", 6))
+    return Xz;
+  if (n >= 3 && !memcmp(magic, "BZh", 3))
+    return Bzip2;
+  return Plain;
+}
+
+bool ChunkReader::supported(Format format) {
+  switch (format) {
+#ifndef USE_LZMA
+    case Xz: return false;
+#endif
+#ifndef USE_BZIP2
+    case Bzip2: return false;
+#endif
+    default: return true;
+  }
+}
+
+ChunkReader::ChunkReader(const char * filepath, Format format)
+    : file(fopen(filepath, "rb")),
+      format(format),
+      done(false),
+      stopped(false),
+      failed(false)
+{
+  if (file)
+    producer = thread(&ChunkReader::produce, this);
+}
+
+ChunkReader::~ChunkReader() {
+  if (producer.joinable()) {
+    {
+      lock_guard<mutex> lock(mtx);
+      stopped = true;
+    }
+    cv.notify_all();
+    producer.join();
+  }
+  if (file) fclose(file);
+}
+
+bool ChunkReader::next(vector<char> & chunk) {
+  unique_lock<mutex> lock(mtx);
+
+  if (chunk.capacity()) empty.push_back(move(chunk));
+  chunk.clear();
+
+  cv.wait(lock, [&] { return !full.empty() || done; });
+  if (full.empty()) return false;
+
+  chunk.swap(full.front());
+  full.pop_front();
+  cv.notify_all();
+  return true;
+}
+
+bool ChunkReader::push(vector<char> & buf) {
+  unique_lock<mutex> lock(mtx);
+  cv.wait(lock, [&] { return full.size() < max_chunks || stopped; });
+  if (stopped) return false;
+
+  full.push_back(move(buf));
+  buf.clear();
+  if (!empty.empty()) {
+    buf.swap(empty.back());
+    empty.pop_back();
+  }
+  cv.notify_all();
+  return true;
+}
+
+void ChunkReader::produce() {
+  bool ok = false;
+  switch (format) {
+    case Plain: ok = readPlain(); break;
+    case Gzip:  ok = readGzip();  break;
+    case Xz:    ok = readXz();    break;
+    case Bzip2: ok = readBzip2(); break;
+  }
+
+  lock_guard<mutex> lock(mtx);
+  done = true;
+  failed = !ok;
+  cv.notify_all();
+}
+
+bool ChunkReader::pump(function<long(char *, size_t)> read) {
+  vector<char> buf;
+  size_t n = 0;
+
+  for (;;) {
+    buf.resize(chunk_size);
+    long r = read(buf.data() + n, chunk_size - n);
+    if (r < 0) return false;
+    n += r;
+    if (n == chunk_size || (r == 0 && n > 0)) {
+      buf.resize(n);
+      if (!push(buf)) return true; // consumer stopped early
+      n = 0;
+    }
+    if (r == 0) return true;
+  }
+}
+
+bool ChunkReader::readPlain() {
+  return pump([&](char * dst, size_t n) -> long {
+    size_t r = fread(dst, 1, n, file);
+    return ferror(file) ? -1 : long(r);
+  });
+}
+
+bool ChunkReader::readGzip() {
+  gzFile gz = gzdopen(dup(fileno(file)), "rb");
+  if (!gz) return false;
+  gzbuffer(gz, 1 << 17);
+
+  bool ok = pump([&](char * dst, size_t n) -> long {
+    return gzread(gz, dst, n);
+  });
+
+  // gzread reports truncated input only through the error state
+  int err = Z_OK;
+  gzerror(gz, &err);
+  if (err != Z_OK) ok = false;
+
+  gzclose(gz);
+  return ok;
+}
+
+bool ChunkReader::readXz() {
+#ifdef USE_LZMA
+  lzma_stream strm = LZMA_STREAM_INIT;
+  if (lzma_stream_decoder(&strm, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+    return false;
+
+  vector<uint8_t> in(1 << 16);
+  lzma_action action = LZMA_RUN;
+  bool finished = false;
+
+  bool ok = pump([&](char * dst, size_t n) -> long {
+    strm.next_out = (uint8_t *) dst;
+    strm.avail_out = n;
+    while (strm.avail_out && !finished) {
+      if (strm.avail_in == 0 && action == LZMA_RUN) {
+        strm.next_in = in.data();
+        strm.avail_in = fread(in.data(), 1, in.size(), file);
+        if (ferror(file)) return -1;
+        if (feof(file)) action = LZMA_FINISH;
+      }
+      lzma_ret ret = lzma_code(&strm, action);
+      if (ret == LZMA_STREAM_END) finished = true;
+      else if (ret != LZMA_OK) return -1;
+    }
+    return n - strm.avail_out;
+  });
+
+  lzma_end(&strm);
+  return ok;
+#else
+  return false;
+#endif
+}
+
+bool ChunkReader::readBzip2() {
+#ifdef USE_BZIP2
+  bz_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) return false;
+
+  vector<char> in(1 << 16);
+  bool eof = false;
+  bool finished = false;
+
+  bool ok = pump([&](char * dst, size_t n) -> long {
+    strm.next_out = dst;
+    strm.avail_out = n;
+    while (strm.avail_out && !finished) {
+      if (strm.avail_in == 0 && !eof) {
+        strm.next_in = in.data();
+        strm.avail_in = fread(in.data(), 1, in.size(), file);
+        if (ferror(file)) return -1;
+        eof = feof(file);
+      }
+      int ret = BZ2_bzDecompress(&strm);
+      if (ret == BZ_STREAM_END) {
+        if (strm.avail_in == 0 && !eof) {
+          int c = fgetc(file);
+          if (c == EOF) eof = true;
+          else ungetc(c, file);
+        }
+        if (strm.avail_in == 0 && eof) {
+          finished = true;
+        } else {
+          // concatenated streams (e.g. from pbzip2): restart the decoder
+          char * next_in = strm.next_in;
+          unsigned avail_in = strm.avail_in;
+          char * next_out = strm.next_out;
+          unsigned avail_out = strm.avail_out;
+          BZ2_bzDecompressEnd(&strm);
+          memset(&strm, 0, sizeof(strm));
+          if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) return -1;
+          strm.next_in = next_in;
+          strm.avail_in = avail_in;
+          strm.next_out = next_out;
+          strm.avail_out = avail_out;
+        }
+      } else if (ret != BZ_OK) {
+        return -1;
+      } else if (strm.avail_in == 0 && eof && strm.avail_out) {
+        return -1; // truncated input
+      }
+    }
+    return n - strm.avail_out;
+  });
+
+  BZ2_bzDecompressEnd(&strm);
+  return ok;
+#else
+  return false;
+#endif
+}
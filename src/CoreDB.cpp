@@ -0,0 +1,86 @@
+#include <algorithm>
+
+#include "CoreDB.h"
+#include "Util.h"
+
+using namespace std;
+
+void CoreDB::grow(int b) {
+  if (unsigned(b) < occurs.size()) return;
+  occurs.resize(b + 1);
+  count.resize(b + 1, 0);
+}
+
+bool CoreDB::add(const vector<int>& core) {
+  // |core & c| for each core c that shares a bvar with core
+  touched.clear();
+  for (int b : core) {
+    grow(b);
+    for (unsigned i : occurs[b])
+      if (!overlap[i]++) touched.push_back(i);
+  }
+
+  bool subsumed = false;
+  evict.clear();
+  for (unsigned i : touched) {
+    if (overlap[i] == core_list[i].size()) subsumed = true;
+    else if (overlap[i] == core.size()) evict.push_back(i);
+    overlap[i] = 0;
+  }
+
+  if (subsumed) {
+    ++n_subsumed;
+    return false;
+  }
+
+  // from the last, so that remove never moves a core still to be evicted
+  sort(evict.begin(), evict.end());
+  for (unsigned j = evict.size(); j--;) remove(evict[j]);
+
+  unsigned id = core_list.size();
+  core_list.push_back(core);
+  overlap.push_back(0);
+  for (int b : core) {
+    occurs[b].push_back(id);
+    ++count[b];
+  }
+  return true;
+}
+
+void CoreDB::remove(unsigned i) {
+  for (int b : core_list[i]) {
+    vector<unsigned>& occ = occurs[b];
+    *find(occ.begin(), occ.end(), i) = occ.back();
+    occ.pop_back();
+    --count[b];
+  }
+
+  unsigned last = core_list.size() - 1;
+  if (i != last) {
+    for (int b : core_list[last])
+      *find(occurs[b].begin(), occurs[b].end(), last) = i;
+    core_list[i].swap(core_list[last]);
+  }
+  core_list.pop_back();
+  overlap.pop_back();
+  ++n_removed;
+}
+
+void CoreDB::fix(int b) {
+  if (unsigned(b) >= occurs.size()) return;
+
+  for (unsigned i : occurs[b]) {
+    vector<int>& core = core_list[i];
+    core.erase(std::remove(core.begin(), core.end(), b), core.end());
+    if (core.empty())
+      terminate(1, "Empty core in core set pruning");
+  }
+  occurs[b].clear();
+  count[b] = 0;
+}
+
+void CoreDB::relax(int b) {
+  if (unsigned(b) >= occurs.size()) return;
+
+  while (!occurs[b].empty()) remove(occurs[b].back());
+}
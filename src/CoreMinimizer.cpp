@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <cassert>
+
+#include "CoreMinimizer.h"
+#include "ProblemInstance.h"
+#include "Util.h"
+
+using namespace std;
+
+CoreMinimizer::CoreMinimizer(ProblemInstance & instance, MinisatSolver * solver,
+                             vector<int> & core)
+    : instance(instance),
+      solver(solver),
+      cfg(GlobalConfig::get()),
+      core(core),
+      members(core),
+      out_of_budget(false),
+      calls(0) {
+  limited = instance.setMinimizeBudget(solver);
+}
+
+CoreMinimizer::Result CoreMinimizer::test(const vector<int> & set) {
+  // tests beyond --limit-minimize count as out of budget
+  if (out_of_budget || ++calls > cfg.minimizeLimit) {
+    out_of_budget = true;
+    return unknown;
+  }
+
+  solver->activateOnly(set);
+  solver->clearAssumptions();
+  solver->assumeBvars();
+
+  if (limited) {
+    if (!solver->findCoreLimited(subcore)) {
+      out_of_budget = true;
+      return unknown;
+    }
+  } else {
+    solver->findCore(subcore);
+  }
+
+  if (subcore.empty()) {
+    instance.minimizerModel(solver);
+    return sat;
+  }
+
+  in_subcore = VarFlags();
+  for (int b : subcore) in_subcore.set(b);
+  // the result if the budget runs out
+  if (subcore.size() < core.size()) core = subcore;
+  return unsat;
+}
+
+void CoreMinimizer::rotate(const vector<int> & within, int c) {
+  if (!cfg.modelRotation) return;
+
+  vector<bool> model;
+  solver->getModel(model);
+  if (!c) c = instance.rotation.falsified(model, within);
+  if (!c) return;
+
+  vector<int> found;
+  instance.rotation.rotate(model, c, within, found, cfg.recursiveRotation);
+  critical.set(c);
+  for (int b : found) critical.set(b);
+}
+
+void CoreMinimizer::refine(vector<int> & lits) const {
+  lits.erase(remove_if(lits.begin(), lits.end(),
+                       [&](int b) { return !in_subcore[b]; }), lits.end());
+}
+
+void CoreMinimizer::moveCritical(vector<int> & lits, vector<int> & mus) const {
+  for (int b : lits)
+    if (critical[b]) mus.push_back(b);
+  lits.erase(remove_if(lits.begin(), lits.end(),
+                       [&](int b) { return critical[b]; }), lits.end());
+}
+
+// For each member c of the core, in order of descending weight, test if
+// the core without c is unsatisfiable, and if it is shrink the core to
+// the conflict.
+void CoreMinimizer::destructive() {
+  log(3, "c CoreMinimizer::destructive (size %lu)\n", core.size());
+
+  vector<int> lits(members);
+  instance.sortByWeight(lits);
+  vector<int> set;
+
+  // lits[0..i-1] are critical
+  for (unsigned i = 0; i < lits.size(); ++i) {
+    int c = lits[i];
+    if (critical[c]) continue;
+
+    set = lits;
+    set.erase(set.begin() + i);
+    Result r = test(set);
+    if (r == unknown) return;
+
+    if (r == unsat) {
+      // c and possibly some of lits[i+1..n] removed,
+      // the critical members before c are in every core
+      refine(lits);
+      --i;
+    } else {
+      critical.set(c);
+      rotate(lits, c);
+    }
+  }
+
+  core.swap(lits);
+}
+
+// Add members to the ones known to be critical until they are
+// unsatisfiable, the last one added is critical too.
+void CoreMinimizer::constructive() {
+  log(3, "c CoreMinimizer::constructive (size %lu)\n", core.size());
+
+  vector<int> mus;
+  vector<int> lits(members);
+  random_shuffle(lits.begin(), lits.end());
+  vector<int> set;
+  vector<int> within;
+
+  while (lits.size()) {
+    within = mus;
+    within.insert(within.end(), lits.begin(), lits.end());
+
+    set = mus;
+    unsigned i = 0;
+    Result r;
+    while ((r = test(set)) == sat) {
+      rotate(within);
+      // cannot happen while mus U lits is unsatisfiable
+      if (i == lits.size()) return;
+      set.push_back(lits[i++]);
+    }
+    if (r == unknown) return;
+
+    // mus is unsatisfiable
+    if (i == 0) break;
+
+    // lits[i - 1] is critical, and only the members
+    // before it in the conflict are left
+    mus.push_back(lits[i - 1]);
+    lits.resize(i - 1);
+    refine(lits);
+    moveCritical(lits, mus);
+  }
+
+  core.swap(mus);
+}
+
+// Find the shortest prefix of the members that is unsatisfiable with
+// the ones known to be critical by binary search, its last member is
+// critical too.
+void CoreMinimizer::binarySearch() {
+  log(3, "c CoreMinimizer::binarySearch (size %lu)\n", core.size());
+
+  vector<int> mus;
+  vector<int> lits(members);
+  random_shuffle(lits.begin(), lits.end());
+  vector<int> set;
+  vector<int> within;
+
+  while (lits.size()) {
+    within = mus;
+    within.insert(within.end(), lits.begin(), lits.end());
+
+    // mus with lits[0..start-1] is satisfiable,
+    // with lits[0..end] unsatisfiable
+    unsigned start = 0;
+    unsigned end = lits.size() - 1;
+
+    while (start != end) {
+      unsigned mid = (start + end) / 2;
+      set = mus;
+      set.insert(set.end(), lits.begin(), lits.begin() + mid + 1);
+
+      Result r = test(set);
+      if (r == unknown) return;
+
+      if (r == sat) {
+        rotate(within);
+        start = mid + 1;
+      } else {
+        // only the members of the conflict are left
+        unsigned kept = 0;
+        for (unsigned i = 0; i < start; ++i)
+          if (in_subcore[lits[i]]) ++kept;
+        lits.resize(mid + 1);
+        refine(lits);
+        start = kept;
+        end = lits.size() - 1;
+      }
+    }
+
+    // lits[start] is critical
+    mus.push_back(lits[start]);
+    lits.erase(lits.begin() + start);
+    moveCritical(lits, mus);
+
+    // loop until mus unsat
+    Result r = test(mus);
+    if (r == unknown) return;
+    if (r == unsat) break;
+
+    within = mus;
+    within.insert(within.end(), lits.begin(), lits.end());
+    rotate(within);
+  }
+
+  core.swap(mus);
+}
+
+// QuickXplain: split the candidates in two and find the members needed
+// from the second half before those needed from the first.
+void CoreMinimizer::quickXplain() {
+  log(3, "c CoreMinimizer::quickXplain (size %lu)\n", core.size());
+
+  vector<int> cands(members);
+  instance.sortByWeight(cands);
+
+  vector<int> base;
+  vector<int> mus;
+  quickXplain(base, cands, mus);
+
+  // out of budget, mus is a core but not necessarily the smallest
+  if (out_of_budget && core.size() <= mus.size()) return;
+  core.swap(mus);
+}
+
+// Appends to mus a minimal subset of cands that is unsatisfiable with
+// base, where base U cands is unsatisfiable and base is not. A test that
+// runs out of budget counts as satisfiable, which keeps more members.
+void CoreMinimizer::quickXplain(vector<int> & base, vector<int> cands,
+                                vector<int> & mus) {
+  if (cands.size() <= 1) {
+    mus.insert(mus.end(), cands.begin(), cands.end());
+    return;
+  }
+
+  unsigned base_size = base.size();
+  unsigned half = cands.size() / 2;
+  vector<int> first(cands.begin(), cands.begin() + half);
+  vector<int> second(cands.begin() + half, cands.end());
+
+  base.insert(base.end(), first.begin(), first.end());
+  if (test(base) == unsat) {
+    // only the first half members of the conflict are needed
+    base.resize(base_size);
+    refine(first);
+    quickXplain(base, first, mus);
+    return;
+  }
+
+  unsigned mus_size = mus.size();
+  quickXplain(base, second, mus);
+
+  base.resize(base_size);
+  base.insert(base.end(), mus.begin() + mus_size, mus.end());
+  if (test(base) != unsat)
+    quickXplain(base, first, mus);
+  base.resize(base_size);
+}
+
+// Progression: find the transition member in the shortest prefix of the
+// candidates that is unsatisfiable with the members found so far, first
+// doubling the prefix and then by binary search. The conflict of the
+// shortest unsatisfiable prefix limits the candidates for the next one.
+void CoreMinimizer::progression() {
+  log(3, "c CoreMinimizer::progression (size %lu)\n", core.size());
+
+  vector<int> mus;
+  vector<int> cands(members);
+  instance.sortByWeight(cands);
+  vector<int> set;
+
+  // tests mus with the first k candidates
+  auto testPrefix = [&](unsigned k) {
+    set = mus;
+    set.insert(set.end(), cands.begin(), cands.begin() + k);
+    Result r = test(set);
+    if (r == sat) {
+      set.insert(set.end(), cands.begin() + k, cands.end());
+      rotate(set);
+    }
+    return r;
+  };
+
+  // the length of the shortest prefix of cands with all of the conflict
+  auto prefix = [&](int hi) {
+    while (hi > 0 && !in_subcore[cands[hi - 1]]) --hi;
+    return hi;
+  };
+
+  while (cands.size()) {
+    // mus with the first lo candidates is satisfiable,
+    // with the first hi unsatisfiable
+    int lo = -1, hi = -1;
+
+    for (unsigned k = 0; hi < 0; k = min(max(2 * k, 1u), unsigned(cands.size()))) {
+      Result r = testPrefix(k);
+      if (r == unknown) return;
+      if (r == unsat) {
+        hi = prefix(k);
+      } else if (k == cands.size()) {
+        // cannot happen while mus U cands is unsatisfiable
+        return;
+      } else {
+        lo = k;
+      }
+    }
+
+    while (hi - lo > 1) {
+      int mid = (lo + hi) / 2;
+      Result r = testPrefix(mid);
+      if (r == unknown) return;
+      if (r == unsat) hi = prefix(mid);
+      else lo = mid;
+    }
+
+    // mus alone is unsatisfiable
+    if (hi == 0) break;
+
+    // cands[hi - 1] is critical, and only the candidates before it in
+    // the conflict of the prefix, the last unsatisfiable test, are left
+    mus.push_back(cands[hi - 1]);
+    cands.resize(hi - 1);
+    refine(cands);
+    moveCritical(cands, mus);
+  }
+
+  core.swap(mus);
+}
@@ -33,7 +33,7 @@ void GlobalConfig::parseArgs(int argc, const char** argv, ostream & out) {
   if (string_beginsWith(nonOptType, "common")) {
     nonoptPrimary = NonoptHS::common;
   } else if (string_beginsWith(nonOptType, "greedy")) {
-    nonoptPrimary = NonoptHS::greedy;
+    nonoptPrimary = NonoptHS::greedy();
   } else if (string_beginsWith(nonOptType, "frac")) {
     nonoptPrimary = NonoptHS::frac(fracSize);
   } else if (string_beginsWith(nonOptType, "disjoint")) {
@@ -43,7 +43,7 @@ void GlobalConfig::parseArgs(int argc, const char** argv, ostream & out) {
   }
 
   if (string_endsWith(nonOptType, "+greedy")) {
-    nonoptSecondary = NonoptHS::greedy;
+    nonoptSecondary = NonoptHS::greedy();
   } else {
     nonoptSecondary = nullptr;
   }
@@ -58,6 +58,10 @@ void GlobalConfig::parseArgs(int argc, const char** argv, ostream & out) {
     minAlg = MinimizeAlgorithm::cardinality;
   } else if (minimizeAlgorithmStr == "rerefute") {
     minAlg = MinimizeAlgorithm::rerefute;
+  } else if (minimizeAlgorithmStr == "quickxplain") {
+    minAlg = MinimizeAlgorithm::quickxplain;
+  } else if (minimizeAlgorithmStr == "progression") {
+    minAlg = MinimizeAlgorithm::progression;
   }    
 
   // validate flags
@@ -94,6 +98,10 @@ void GlobalConfig::parseArgs(int argc, const char** argv, ostream & out) {
 
   srand(randomSeed);
 
+  // portfolio workers read the bvars without locks, so the
+  // hitting set solver must not harden them meanwhile
+  if (portfolio > 1) CPLEX_reducedCosts = false;
+
   is_LCNF = inFileAssumptions || preprocess;
   use_LP = lpNonOpt || CPLEX_reducedCosts;
 
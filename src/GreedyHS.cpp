@@ -0,0 +1,81 @@
+#include <algorithm>
+
+#include "GreedyHS.h"
+#include "Util.h"
+
+using namespace std;
+
+GreedyHS::GreedyHS() : start(1, 0) { }
+
+void GreedyHS::clear() {
+  start.assign(1, 0);
+  lits.clear();
+  for (int v : vars) occurs[v].clear();
+  vars.clear();
+}
+
+void GreedyHS::add(const vector<int>& core) {
+  unsigned id = start.size() - 1;
+  for (int v : core) {
+    if (unsigned(v) >= occurs.size()) occurs.resize(v + 1);
+    if (occurs[v].empty()) vars.push_back(v);
+    occurs[v].push_back(id);
+    lits.push_back(v);
+  }
+  start.push_back(lits.size());
+}
+
+void GreedyHS::solve(vector<int>& out_hs, const vector<vector<int>>& cores,
+                     const BvarTable& weights, bool changed) {
+  unsigned n_cores = start.size() - 1;
+  if (changed || cores.size() < n_cores) {
+    clear();
+    n_cores = 0;
+  }
+  for (; n_cores < cores.size(); ++n_cores) add(cores[n_cores]);
+
+  out_hs.clear();
+  log(2, "c finding greedy hitting set of %ld cores\n", cores.size());
+
+  if (count.size() < occurs.size()) count.resize(occurs.size());
+  heap.clear();
+  for (int v : vars) {
+    count[v] = occurs[v].size();
+    heap.push_back({ double(weights.weightOf(v)) / count[v], count[v], v });
+  }
+  make_heap(heap.begin(), heap.end());
+  hit.assign(n_cores, false);
+
+  unsigned unhits = n_cores;
+  weight_t weight = 0;
+
+  // repeat until all cores are hit
+  while (unhits) {
+    Entry e = heap.front();
+    pop_heap(heap.begin(), heap.end());
+    heap.pop_back();
+
+    int v = e.var;
+    if (e.count != count[v]) {
+      // some of the cores of v were hit after the entry was pushed
+      if (count[v]) {
+        heap.push_back({ double(weights.weightOf(v)) / count[v], count[v], v });
+        push_heap(heap.begin(), heap.end());
+      }
+      continue;
+    }
+
+    weight += weights.weightOf(v);
+    out_hs.push_back(v);
+
+    for (unsigned c : occurs[v]) {
+      if (hit[c]) continue;
+      hit[c] = true;
+      --unhits;
+      // each variable of the core hits one core less
+      for (unsigned i = start[c]; i < start[c + 1]; ++i) --count[lits[i]];
+    }
+  }
+
+  log(2, "c found greedy hs with cost %" WGT_FMT "\n", weight);
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+
+#include "HSLocalSearch.h"
+#include "Timer.h"
+#include "Util.h"
+
+using namespace std;
+
+void HSLocalSearch::build(const vector<int>& hs, const vector<vector<int>>& cores) {
+  this->cores = &cores;
+
+  for (int v : vars) occurs[v].clear();
+  vars.clear();
+  for (unsigned i = 0; i < cores.size(); ++i) {
+    for (int v : cores[i]) {
+      if (unsigned(v) >= occurs.size()) occurs.resize(v + 1);
+      if (occurs[v].empty()) vars.push_back(v);
+      occurs[v].push_back(i);
+    }
+  }
+  for (int v : hs)
+    if (unsigned(v) >= occurs.size()) occurs.resize(v + 1);
+
+  in_hs.assign(occurs.size(), 0);
+  tabu_until.assign(occurs.size(), 0);
+  cover.assign(cores.size(), 0);
+  in_unique.assign(cores.size(), 0);
+
+  for (int v : hs)
+    if (!in_hs[v]) add(v);
+}
+
+void HSLocalSearch::add(int v) {
+  in_hs[v] = 1;
+  for (unsigned c : occurs[v]) ++cover[c];
+}
+
+void HSLocalSearch::remove(int v) {
+  in_hs[v] = 0;
+  for (unsigned c : occurs[v]) --cover[c];
+}
+
+bool HSLocalSearch::redundant(int v) const {
+  for (unsigned c : occurs[v])
+    if (cover[c] < 2) return false;
+  return true;
+}
+
+int HSLocalSearch::swapFor(int v, const BvarTable& weights, unsigned iteration) {
+  unique.clear();
+  for (unsigned c : occurs[v])
+    if (cover[c] == 1) unique.push_back(c);
+  if (unique.empty()) return -1;
+  for (unsigned c : unique) in_unique[c] = 1;
+
+  // a bvar in every core of unique is in the first one, the cheapest
+  // wins and then the one in the most cores. Swapping v for one as
+  // heavy must at least put more cores under the hitting set.
+  int best = -1;
+  weight_t best_w = weights.weightOf(v);
+  unsigned best_occurs = occurs[v].size();
+  for (int u : (*cores)[unique[0]]) {
+    if (in_hs[u] || tabu_until[u] > iteration) continue;
+    weight_t w = weights.weightOf(u);
+    if (w > best_w || (w == best_w && occurs[u].size() <= best_occurs)) continue;
+
+    unsigned n = 0;
+    for (unsigned c : occurs[u])
+      if (in_unique[c]) ++n;
+    if (n < unique.size()) continue;
+
+    best = u;
+    best_w = w;
+    best_occurs = occurs[u].size();
+  }
+
+  for (unsigned c : unique) in_unique[c] = 0;
+  return best;
+}
+
+void HSLocalSearch::improve(vector<int>& hs, const vector<vector<int>>& cores,
+                            const BvarTable& weights, double time_limit) {
+  if (time_limit <= 0 || hs.empty()) return;
+
+  Timer timer;
+  timer.start();
+  build(hs, cores);
+
+  vector<int> members;
+  weight_t before = 0;
+  for (int v : hs) {
+    if (!in_hs[v] || find(members.begin(), members.end(), v) != members.end()) continue;
+    members.push_back(v);
+    before += weights.weightOf(v);
+  }
+
+  // the heaviest bvars first, both to drop and to swap
+  sort(members.begin(), members.end(), [&](int a, int b) {
+    return weights.weightOf(a) > weights.weightOf(b);
+  });
+
+  // a bvar swapped out may not come back for this many swaps
+  const unsigned tenure = 10;
+  unsigned iteration = 0;
+  unsigned long limit_ms = time_limit * 1000;
+
+  for (bool moved = true; moved;) {
+    moved = false;
+    for (unsigned i = 0; i < members.size(); ++i) {
+      if (timer.real_ms_current() >= limit_ms) goto done;
+
+      int v = members[i];
+      if (!in_hs[v]) continue;
+
+      if (redundant(v)) {
+        remove(v);
+        moved = true;
+        continue;
+      }
+
+      int u = swapFor(v, weights, iteration);
+      if (u < 0) continue;
+      remove(v);
+      add(u);
+      members.push_back(u);
+      tabu_until[v] = ++iteration + tenure;
+      moved = true;
+    }
+
+    members.erase(remove_if(members.begin(), members.end(),
+                            [&](int v) { return !in_hs[v]; }), members.end());
+  }
+
+done:
+  hs.clear();
+  weight_t after = 0;
+  for (int v : members) {
+    if (!in_hs[v]) continue;
+    in_hs[v] = 0;
+    hs.push_back(v);
+    after += weights.weightOf(v);
+  }
+
+  log(2, "c local search: hs cost %" WGT_FMT " -> %" WGT_FMT " in %lu ms\n",
+      before, after, timer.real_ms_current());
+}
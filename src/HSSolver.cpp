@@ -0,0 +1,21 @@
+#include "HSSolver.h"
+#include "MCHSSolver.h"
+#include "GlobalConfig.h"
+#include "Util.h"
+
+#if defined(MIP_CPLEX)
+#include "CPLEXSolver.h"
+#endif
+
+HSSolver * newHSSolver() {
+  GlobalConfig & cfg = GlobalConfig::get();
+
+#if defined(MIP_CPLEX)
+  if (cfg.HS_solver != "builtin") return new CPLEXSolver();
+#else
+  condTerminate(cfg.HS_solver == "cplex", 1,
+                "Error: LMHS was built without CPLEX (make CPLEX=1)\n");
+#endif
+
+  return new MCHSSolver();
+}
@@ -0,0 +1,305 @@
+#include <cstdio>
+#include <cstring>  // memcmp, memcpy
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "InstanceCache.h"
+#include "preprocessorinterface.hpp"
+#include "VarMapper.h"
+#include "GlobalConfig.h"
+#include "Util.h"
+
+using namespace std;
+
+namespace {
+
+const char cache_magic[8] = {'L', 'M', 'H', 'S', 'I', 'N', 'S', 'T'};
+
+// bump whenever the layout below changes
+const uint32_t cache_version = 1;
+
+enum CacheFlags : uint32_t {
+  CACHE_FLOAT_WEIGHTS = 1,
+  CACHE_PREPROCESSED  = 2,
+  CACHE_WEIGHTED      = 4,
+  CACHE_VARMAP        = 8
+};
+
+struct CacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  // identifies the input file the cache was built from
+  uint64_t input_size;
+  int64_t input_mtime_sec;
+  int64_t input_mtime_nsec;
+  weight_t top;
+  int32_t n_vars;
+  int32_t input_vars;             // VarMapper::n_vars
+  int32_t pp_variables;           // MaxPre reconstruction state
+  int32_t pp_original_variables;
+  uint64_t pp_removed_weight;
+};
+
+static_assert(sizeof(weight_t) == 8, "cache layout assumes 8-byte weights");
+static_assert(sizeof(CacheHeader) % 8 == 0, "cache header must keep arrays aligned");
+
+// Header is followed by these arrays, each as a uint64 length and
+// the elements, zero padded to a multiple of 8 bytes:
+//   pre_techniques, offsets, lits, weights, assumptions, branchVars,
+//   varmap inverse, MaxPre solver->pp variables, trace operations,
+//   trace data offsets, trace data
+
+// flags that must match between the cache and the current run
+uint32_t runFlags(bool preprocessed, bool varmap) {
+  uint32_t flags = 0;
+#if defined(FLOAT_WEIGHTS)
+  flags |= CACHE_FLOAT_WEIGHTS;
+#endif
+  if (preprocessed) flags |= CACHE_PREPROCESSED;
+  if (varmap) flags |= CACHE_VARMAP;
+  return flags;
+}
+
+class CacheWriter {
+ public:
+  explicit CacheWriter(FILE * f) : ok(true), f(f) { }
+
+  bool ok;
+
+  void raw(const void * data, size_t n) {
+    static const char zeros[8] = {0};
+    if (n && fwrite(data, 1, n, f) != n) ok = false;
+    size_t pad = (8 - n % 8) % 8;
+    if (pad && fwrite(zeros, 1, pad, f) != pad) ok = false;
+  }
+
+  template <class T>
+  void array(const T * data, uint64_t n) {
+    raw(&n, sizeof(n));
+    raw(data, n * sizeof(T));
+  }
+
+  template <class T>
+  void array(const vector<T> & v) { array(v.data(), v.size()); }
+
+ private:
+  FILE * f;
+};
+
+// bounds-checked cursor over the mapped file
+class CacheReader {
+ public:
+  CacheReader(const char * begin, const char * end) : ok(true), p(begin), end(end) { }
+
+  bool ok;
+
+  const void * raw(size_t n) {
+    size_t padded = (n + 7) & ~size_t(7);
+    if (!ok || size_t(end - p) < padded) {
+      ok = false;
+      return nullptr;
+    }
+    const char * data = p;
+    p += padded;
+    return data;
+  }
+
+  template <class T>
+  void array(vector<T> & out) {
+    const void * len = raw(sizeof(uint64_t));
+    if (!ok) return;
+    uint64_t n;
+    memcpy(&n, len, sizeof(n));
+    if (n > size_t(end - p) / sizeof(T)) {
+      ok = false;
+      return;
+    }
+    const T * data = (const T *) raw(n * sizeof(T));
+    out.assign(data, data + n);
+  }
+
+ private:
+  const char * p;
+  const char * end;
+};
+
+} // namespace
+
+bool writeInstanceCache(const char * cache_path, const char * wcnf_path,
+                        const WCNFData & wcnf, VarMapper * varmap,
+                        maxPreprocessor::PreprocessorInterface * preprocessor) {
+  GlobalConfig & cfg = GlobalConfig::get();
+
+  struct stat st;
+  if (stat(wcnf_path, &st) != 0) return false;
+
+  vector<int> solver_to_pp;
+  maxPreprocessor::Trace trace;
+  int pp_variables = 0, pp_original_variables = 0;
+  if (preprocessor)
+    preprocessor->getReconstructionState(solver_to_pp, pp_variables,
+                                         pp_original_variables, trace);
+
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, cache_magic, sizeof(cache_magic));
+  header.version = cache_version;
+  header.flags = runFlags(preprocessor != nullptr, varmap != nullptr);
+  if (wcnf.weighted) header.flags |= CACHE_WEIGHTED;
+  header.input_size = st.st_size;
+  header.input_mtime_sec = st.st_mtim.tv_sec;
+  header.input_mtime_nsec = st.st_mtim.tv_nsec;
+  header.top = wcnf.top;
+  header.n_vars = wcnf.n_vars;
+  header.input_vars = varmap ? varmap->n_vars : 0;
+  header.pp_variables = pp_variables;
+  header.pp_original_variables = pp_original_variables;
+  header.pp_removed_weight = trace.removedWeight;
+
+  // write to a temporary file and rename, so that concurrent runs never
+  // see a partially written cache
+  string tmp_path = string(cache_path) + ".tmp" + to_string(getpid());
+  FILE * f = fopen(tmp_path.c_str(), "wb");
+  if (!f) return false;
+
+  CacheWriter out(f);
+  out.raw(&header, sizeof(header));
+  out.array(cfg.pre_techniques.data(), cfg.pre_techniques.size());
+  out.array(wcnf.offsets);
+  out.array(wcnf.lits);
+  out.array(wcnf.weights);
+  out.array(wcnf.assumptions);
+  out.array(wcnf.branchVars);
+  out.array(varmap ? varmap->inverse() : vector<int>());
+  out.array(solver_to_pp);
+  out.array(trace.operations);
+
+  vector<uint64_t> data_offsets(1, 0);
+  vector<int> data;
+  for (auto & d : trace.data) {
+    data.insert(data.end(), d.begin(), d.end());
+    data_offsets.push_back(data.size());
+  }
+  out.array(data_offsets);
+  out.array(data);
+
+  bool ok = out.ok && fclose(f) == 0;
+  if (ok) ok = rename(tmp_path.c_str(), cache_path) == 0;
+  if (!ok) unlink(tmp_path.c_str());
+  return ok;
+}
+
+bool readInstanceCache(const char * cache_path, const char * wcnf_path,
+                       WCNFData & wcnf, VarMapper * varmap,
+                       maxPreprocessor::PreprocessorInterface *& preprocessor) {
+  GlobalConfig & cfg = GlobalConfig::get();
+
+  struct stat input_st;
+  if (stat(wcnf_path, &input_st) != 0) return false;
+
+  int fd = open(cache_path, O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CacheHeader)) {
+    close(fd);
+    return false;
+  }
+
+  size_t size = st.st_size;
+  void * map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return false;
+
+  const char * begin = (const char *) map;
+  CacheReader in(begin, begin + size);
+
+  CacheHeader header;
+  memcpy(&header, in.raw(sizeof(header)), sizeof(header));
+
+  vector<char> pre_techniques;
+  in.array(pre_techniques);
+
+  bool weighted = header.flags & CACHE_WEIGHTED;
+  bool preprocessed = header.flags & CACHE_PREPROCESSED;
+
+  bool fresh = !memcmp(header.magic, cache_magic, sizeof(cache_magic)) &&
+               header.version == cache_version &&
+               (header.flags & ~CACHE_WEIGHTED) == runFlags(cfg.preprocess, varmap != nullptr) &&
+               header.input_size == uint64_t(input_st.st_size) &&
+               header.input_mtime_sec == input_st.st_mtim.tv_sec &&
+               header.input_mtime_nsec == input_st.st_mtim.tv_nsec &&
+               (!preprocessed || string(pre_techniques.begin(), pre_techniques.end()) == cfg.pre_techniques);
+
+  if (!in.ok || !fresh) {
+    munmap(map, size);
+    log(1, "c instance cache %s is stale\n", cache_path);
+    return false;
+  }
+
+  wcnf.top = header.top;
+  wcnf.n_vars = header.n_vars;
+  wcnf.weighted = weighted;
+  in.array(wcnf.offsets);
+  in.array(wcnf.lits);
+  in.array(wcnf.weights);
+  in.array(wcnf.assumptions);
+  in.array(wcnf.branchVars);
+
+  vector<int> inverse;
+  in.array(inverse);
+
+  vector<int> solver_to_pp;
+  maxPreprocessor::Trace trace;
+  vector<uint64_t> data_offsets;
+  vector<int> data;
+  in.array(solver_to_pp);
+  in.array(trace.operations);
+  in.array(data_offsets);
+  in.array(data);
+
+  munmap(map, size);
+
+  // sanity check the arrays before handing them out
+  bool ok = in.ok &&
+            wcnf.offsets.size() == wcnf.weights.size() + 1 &&
+            wcnf.offsets.front() == 0 && wcnf.offsets.back() == wcnf.lits.size() &&
+            data_offsets.size() == trace.operations.size() + 1 &&
+            data_offsets.back() == data.size();
+  for (unsigned i = 1; ok && i < wcnf.offsets.size(); ++i)
+    ok = wcnf.offsets[i - 1] <= wcnf.offsets[i];
+  for (unsigned i = 1; ok && i < data_offsets.size(); ++i)
+    ok = data_offsets[i - 1] <= data_offsets[i];
+
+  if (!ok) {
+    log(1, "c instance cache %s is corrupt\n", cache_path);
+    wcnf = WCNFData();
+    return false;
+  }
+
+  if (varmap) {
+    varmap->n_vars = header.input_vars;
+    varmap->setInverse(inverse);
+  }
+
+  if (preprocessed) {
+    trace.removedWeight = header.pp_removed_weight;
+    for (unsigned i = 0; i < trace.operations.size(); ++i)
+      trace.data.emplace_back(data.begin() + data_offsets[i],
+                              data.begin() + data_offsets[i + 1]);
+    preprocessor = new maxPreprocessor::PreprocessorInterface(
+        solver_to_pp, header.pp_variables, header.pp_original_variables,
+        trace, wcnf.top);
+  } else {
+    preprocessor = nullptr;
+  }
+
+  return true;
+}
@@ -111,7 +111,7 @@ void printStats() { solver->printStats(); }
 void declareBvar(int var, weight_t weight, bool pol) {
   solver->instance.addBvar(var, weight);
   if (!pol)
-    solver->instance.flippedInternalVarPolarity[abs(var)] = true;
+    solver->instance.flippedInternalVarPolarity.set(abs(var));
 }
 
 }
\ No newline at end of file
@@ -13,6 +13,7 @@ extern "C" {
 #include "Solver.h"
 #include "ProblemInstance.h"
 #include "VarMapper.h"
+#include "WCNFParser.h"
 #include "Util.h"
 #include "Timer.h"
 
@@ -35,9 +36,9 @@ void LMHS_setArgs(int argc, const char* argv[]) {
 }
 
 int LMHS_initializeWithFile(const char* filepath) {
-  ifstream file(filepath);
-  instance = new ProblemInstance(file, nullstream);
-  file.close();
+  WCNFData wcnf;
+  if (!parseWCNFFile(filepath, wcnf)) return 0;
+  instance = new ProblemInstance(wcnf, nullstream);
   solver = new Solver(*instance, nullstream);
   return 1;
 }
@@ -134,5 +135,5 @@ void LMHS_printStats() { solver->printStats(); }
 void LMHS_declareBvar(int var, weight_t weight, bool pol) {
   solver->instance.addBvar(var, weight);
   if (!pol)
-    solver->instance.flippedInternalVarPolarity[abs(var)] = true;
+    solver->instance.flippedInternalVarPolarity.set(abs(var));
 }
\ No newline at end of file
@@ -0,0 +1,693 @@
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <climits>
+#include <cmath>
+
+#include "MCHSSolver.h"
+#include "ProblemInstance.h"
+#include "GlobalConfig.h"
+#include "Util.h"
+
+using namespace std;
+
+// subgradient iterations for the Lagrangian bound
+static const unsigned ROOT_LAG_ITERS = 300;
+static const unsigned NODE_LAG_ITERS = 5;
+static const unsigned STALL_ITERS = 10;
+
+MCHSSolver::MCHSSolver()
+  : solver_calls(0), lp_calls(0), nodes(0), stamp(0), stop(false),
+    target_cost(0), stop_below_cutoff(false), cutoff_cost(0),
+    clique_edges(0), lag_iters(ROOT_LAG_ITERS), lag_bound(0), n_lag_cons(0),
+    best_cost(0), solutionExists(false), last_opt(0) { }
+
+unsigned MCHSSolver::column(int var) {
+  if (unsigned(var) >= var_col.size()) var_col.resize(var + 1, -1);
+  if (var_col[var] < 0) {
+    var_col[var] = col_var.size();
+    col_var.push_back(var);
+    col_weight.push_back(0);
+    col_obj.push_back(false);
+    best_val.push_back(0);
+    occ.emplace_back();
+    occ.emplace_back();
+  }
+  return var_col[var];
+}
+
+void MCHSSolver::addVariable(int var) {
+  log(2, "c MIP variable %d\n", var);
+  column(var);
+}
+
+void MCHSSolver::addObjectiveVariable(int bVar, weight_t weight) {
+  log(2, "c MIP obj variable %d %" WGT_FMT "\n", bVar, weight);
+  unsigned c = column(bVar);
+  col_weight[c] = weight;
+  col_obj[c] = true;
+}
+
+void MCHSSolver::addObjectiveVariables(const BvarTable & bvars) {
+  for (auto b_w : bvars) addObjectiveVariable(b_w.first, b_w.second);
+}
+
+void MCHSSolver::addClause(const vector<int>& lits) {
+  unsigned k = cons.add(lits);
+  for (int l : lits) {
+    Bitset & b = occ[l];
+    if (b.size() <= (k >> 6)) b.resize((k >> 6) + 1, 0);
+    b[k >> 6] |= uint64_t(1) << (k & 63);
+  }
+}
+
+void MCHSSolver::addConstraint(vector<int>& core, double bound, Comparator comp) {
+  condTerminate(core.empty(), 1,
+    "MCHSSolver::addConstraint - empty constraint\n");
+  condTerminate(comp != GTE || bound != 1.0, 1,
+    "MCHSSolver::addConstraint - only clause constraints are supported\n");
+
+  log(2, "c adding MIP constraint (size %lu)\n", core.size());
+  logCore(3, core);
+
+  vector<int> lits;
+  lits.reserve(core.size());
+  for (int l : core) lits.push_back(2 * column(abs(l)) + (l < 0));
+
+  // the search assumes no duplicate literals or tautologies
+  sort(lits.begin(), lits.end());
+  lits.erase(unique(lits.begin(), lits.end()), lits.end());
+  for (unsigned i = 1; i < lits.size(); ++i)
+    if ((lits[i] ^ 1) == lits[i - 1]) return;
+
+  addClause(lits);
+}
+
+// disallow the last solution by requiring that the next one contains an
+// objective variable outside it and leaves out one inside it
+void MCHSSolver::forbidCurrentSolution() {
+  condTerminate(!solutionExists, 1,
+    "MCHSSolver::forbidCurrentSolution - no current hitting set exists\n");
+
+  vector<int> sub, super;
+  for (unsigned c = 0; c < col_var.size(); ++c) {
+    if (!col_obj[c]) continue;
+    if (best_val[c]) super.push_back(2 * c + 1);
+    else             sub.push_back(2 * c);
+  }
+  // an empty clause makes the problem infeasible, as intended
+  addClause(sub);
+  addClause(super);
+}
+
+// Greedy clique cover of the graph whose edges are the binary constraints
+// without negative literals. Each edge not yet covered is grown into a
+// clique with common neighbours. All but one column of a clique must be
+// true, which the edges alone only imply with an integral solution.
+void MCHSSolver::findCliques() {
+  unsigned n_cols = col_var.size();
+  vector<vector<unsigned>> adj(n_cols);
+  unsigned edges = 0;
+  for (unsigned k = 0; k < cons.size(); ++k) {
+    if (cons.clauseSize(k) != 2) continue;
+    int a = cons.begin(k)[0], b = cons.begin(k)[1];
+    if ((a | b) & 1) continue;
+    adj[a >> 1].push_back(b >> 1);
+    adj[b >> 1].push_back(a >> 1);
+    ++edges;
+  }
+  if (edges == clique_edges) return;
+  clique_edges = edges;
+
+  cliques = ClauseArena();
+  clique_mult.clear();
+
+  vector<vector<bool>> covered(n_cols);
+  for (unsigned c = 0; c < n_cols; ++c) {
+    sort(adj[c].begin(), adj[c].end());
+    adj[c].erase(unique(adj[c].begin(), adj[c].end()), adj[c].end());
+    covered[c].assign(adj[c].size(), false);
+  }
+  auto adjacent = [&](unsigned a, unsigned b) {
+    return binary_search(adj[a].begin(), adj[a].end(), b);
+  };
+  auto cover = [&](unsigned a, unsigned b) {
+    covered[a][lower_bound(adj[a].begin(), adj[a].end(), b) - adj[a].begin()] = true;
+    covered[b][lower_bound(adj[b].begin(), adj[b].end(), a) - adj[b].begin()] = true;
+  };
+
+  vector<unsigned> order(n_cols);
+  for (unsigned c = 0; c < n_cols; ++c) order[c] = c;
+  sort(order.begin(), order.end(), [&](unsigned a, unsigned b) {
+    return adj[a].size() > adj[b].size();
+  });
+
+  vector<unsigned> clique;
+  vector<int> lits;
+  for (unsigned v : order) {
+    for (unsigned i = 0; i < adj[v].size(); ++i) {
+      if (covered[v][i]) continue;
+      unsigned u = adj[v][i];
+      clique.assign({v, u});
+      for (unsigned w : adj[v]) {
+        if (w == u || !adjacent(u, w)) continue;
+        bool all = true;
+        for (unsigned j = 2; j < clique.size() && all; ++j)
+          all = adjacent(clique[j], w);
+        if (all) clique.push_back(w);
+      }
+      for (unsigned a = 0; a < clique.size(); ++a)
+        for (unsigned b = a + 1; b < clique.size(); ++b)
+          cover(clique[a], clique[b]);
+      // an edge is already a constraint
+      if (clique.size() < 3) continue;
+      lits.clear();
+      for (unsigned c : clique) lits.push_back(2 * c);
+      cliques.add(lits);
+    }
+  }
+  clique_mult.assign(cliques.size(), 0);
+  log(2, "c MCHS: %u cliques over %u edges\n", cliques.size(), edges);
+}
+
+void MCHSSolver::prepare() {
+  unsigned n_cols = col_var.size();
+  val.assign(n_cols, -1);
+  trail.clear();
+  resid.resize(n_cols);
+  resid_stamp.assign(n_cols, 0);
+  stamp = 0;
+  // multipliers of old constraints are kept as a starting point
+  mult.resize(cons.size(), 0);
+  lag_iters = ROOT_LAG_ITERS;
+  findCliques();
+
+  // the bound is stronger when short constraints are charged first
+  cons_order.resize(cons.size());
+  for (unsigned k = 0; k < cons.size(); ++k) cons_order[k] = k;
+  stable_sort(cons_order.begin(), cons_order.end(), [&](unsigned a, unsigned b) {
+    return cons.clauseSize(a) < cons.clauseSize(b);
+  });
+}
+
+void MCHSSolver::assign(int lit, Bitset & sat, weight_t & cost) {
+  val[lit >> 1] = (lit & 1) ? 0 : 1;
+  trail.push_back(lit >> 1);
+  cost += litCost(lit);
+  const Bitset & b = occ[lit];
+  for (unsigned w = 0; w < b.size(); ++w) sat[w] |= b[w];
+}
+
+void MCHSSolver::undo(size_t trail_size) {
+  while (trail.size() > trail_size) {
+    val[trail.back()] = -1;
+    trail.pop_back();
+  }
+}
+
+bool MCHSSolver::propagate(Bitset & sat, weight_t & cost, int & pick) {
+  unsigned n = cons.size();
+  for (bool changed = true; changed; ) {
+    changed = false;
+    pick = -1;
+    unsigned pick_free = UINT_MAX;
+    for (unsigned w = 0; w < sat.size(); ++w) {
+      uint64_t bits = ~sat[w];
+      if (w == sat.size() - 1 && n % 64) bits &= (uint64_t(1) << (n % 64)) - 1;
+      while (bits) {
+        unsigned k = w * 64 + __builtin_ctzll(bits);
+        bits &= bits - 1;
+        // may have been satisfied by a propagation in this pass
+        if (isSat(sat, k)) continue;
+
+        // literals of assigned columns are false in unsatisfied constraints
+        unsigned n_free = 0;
+        int free_lit = -1;
+        bool free_neg = false;
+        for (const int * l = cons.begin(k); l != cons.end(k); ++l) {
+          if (val[*l >> 1] < 0) {
+            ++n_free;
+            free_lit = *l;
+            free_neg |= *l & 1;
+          }
+        }
+
+        if (n_free == 0) return false;
+        if (n_free == 1) {
+          assign(free_lit, sat, cost);
+          changed = true;
+        } else if (!free_neg && n_free < pick_free) {
+          pick = k;
+          pick_free = n_free;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Greedy dual bound: each unsatisfied constraint is charged the smallest
+// remaining weight of its free variables, which is then taken from all of
+// them. Constraints that a free negative literal satisfies at no cost are
+// skipped.
+weight_t MCHSSolver::lowerBound(const Bitset & sat, weight_t limit) {
+  if (++stamp == 0) {
+    resid_stamp.assign(resid_stamp.size(), 0);
+    stamp = 1;
+  }
+
+  weight_t lb = 0;
+  for (unsigned k : cons_order) {
+    if (isSat(sat, k)) continue;
+
+    weight_t y = numeric_limits<weight_t>::max();
+    for (const int * l = cons.begin(k); l != cons.end(k); ++l) {
+      unsigned c = *l >> 1;
+      if (val[c] >= 0) continue;
+      if (*l & 1) {
+        y = 0;
+        break;
+      }
+      if (resid_stamp[c] != stamp) {
+        resid_stamp[c] = stamp;
+        resid[c] = col_weight[c];
+      }
+      y = min(y, resid[c]);
+    }
+    if (y == 0 || y == numeric_limits<weight_t>::max()) continue;
+
+    lb += y;
+    if (lb >= limit) return lb;
+    for (const int * l = cons.begin(k); l != cons.end(k); ++l)
+      if (val[*l >> 1] < 0) resid[*l >> 1] -= y;
+  }
+  return lb;
+}
+
+weight_t MCHSSolver::safeBound(double bound) const {
+  if (bound <= 0) return 0;
+  // rounding errors must not prune solutions
+  bound -= 1e-9 * bound + 1e-6;
+#if defined(FLOAT_WEIGHTS)
+  return max(bound, 0.0);
+#else
+  return bound <= 0 ? 0 : weight_t(ceil(bound));
+#endif
+}
+
+// Subgradient optimization of the Lagrangian relaxation of the unsatisfied
+// constraints. Each multiplier u_k prices constraint k, written as
+// sum(P) - sum(N) >= 1 - |N| over its free positive and negative
+// literals. For any u >= 0 the relaxed minimum
+//   sum_k u_k (1 - |N_k|) + sum_c min(0, w_c - sum_{k: c in P_k} u_k
+//                                         + sum_{k: c in N_k} u_k)
+// is a lower bound, and its maximum is the LP bound. Unlike the greedy
+// bound, negative literals move weight between columns.
+weight_t MCHSSolver::lagrangianBound(const Bitset & sat, weight_t limit, unsigned iters) {
+  // the free literals of the unsatisfied constraints, gathered once
+  active.clear();
+  lag_start.clear();
+  lag_lits.clear();
+  lag_rhs.clear();
+  for (unsigned k = 0; k < cons.size(); ++k) {
+    if (isSat(sat, k)) continue;
+    active.push_back(k);
+    lag_start.push_back(lag_lits.size());
+    int rhs = 1;
+    for (const int * l = cons.begin(k); l != cons.end(k); ++l) {
+      if (val[*l >> 1] >= 0) continue;
+      lag_lits.push_back(*l);
+      rhs -= *l & 1;
+    }
+    lag_rhs.push_back(rhs);
+  }
+  n_lag_cons = active.size();
+
+  // clique rows, sum of the free columns >= |Q| - 1 - (true columns)
+  for (unsigned q = 0; q < cliques.size(); ++q) {
+    int rhs = cliques.clauseSize(q) - 1;
+    for (const int * l = cliques.begin(q); l != cliques.end(q); ++l)
+      rhs -= val[*l >> 1] == 1;
+    if (rhs <= 0) continue;
+    active.push_back(cons.size() + q);
+    lag_start.push_back(lag_lits.size());
+    for (const int * l = cliques.begin(q); l != cliques.end(q); ++l)
+      if (val[*l >> 1] < 0) lag_lits.push_back(*l);
+    lag_rhs.push_back(rhs);
+  }
+  lag_start.push_back(lag_lits.size());
+
+  free_cols.clear();
+  for (unsigned c = 0; c < val.size(); ++c)
+    if (val[c] < 0) free_cols.push_back(c);
+
+  lag_rc.resize(val.size());
+  lag_best_rc.resize(val.size());
+  subgrad.resize(active.size());
+  double best = -numeric_limits<double>::infinity();
+  double scale = 1;
+  unsigned stalled = 0;
+
+  for (unsigned it = 0; it < iters; ++it) {
+    for (unsigned c : free_cols) lag_rc[c] = double(col_weight[c]);
+
+    double bound = 0;
+    for (unsigned i = 0; i < active.size(); ++i) {
+      double u = rowMult(active[i]);
+      for (unsigned j = lag_start[i]; j < lag_start[i + 1]; ++j) {
+        int l = lag_lits[j];
+        lag_rc[l >> 1] += (l & 1) ? u : -u;
+      }
+      bound += u * lag_rhs[i];
+      subgrad[i] = lag_rhs[i];
+    }
+    for (unsigned c : free_cols)
+      if (lag_rc[c] < 0) bound += lag_rc[c];
+
+    if (bound > best) {
+      best = bound;
+      for (unsigned c : free_cols) lag_best_rc[c] = lag_rc[c];
+      if (safeBound(best) >= limit) break;
+      stalled = 0;
+    } else if (++stalled == STALL_ITERS) {
+      // the target is too far, take shorter steps
+      scale /= 2;
+      stalled = 0;
+    }
+
+    // subgradient at the relaxed minimum, where a column is true
+    // exactly when its reduced cost is negative
+    double norm = 0;
+    for (unsigned i = 0; i < active.size(); ++i) {
+      for (unsigned j = lag_start[i]; j < lag_start[i + 1]; ++j) {
+        int l = lag_lits[j];
+        if (lag_rc[l >> 1] < 0) subgrad[i] += (l & 1) ? 1 : -1;
+      }
+      if (rowMult(active[i]) > 0 || subgrad[i] > 0) norm += subgrad[i] * subgrad[i];
+    }
+    // the relaxed minimum satisfies every row
+    if (norm == 0) break;
+
+    // step towards the best solution, or some way up without one
+    double target = best_cost == numeric_limits<weight_t>::max()
+      ? 1.1 * bound + 1 : double(limit);
+    double step = scale * (target - bound) / norm;
+    for (unsigned i = 0; i < active.size(); ++i) {
+      double & u = rowMult(active[i]);
+      u = max(0.0, u + step * subgrad[i]);
+    }
+  }
+  lag_bound = best;
+  return safeBound(best);
+}
+
+void MCHSSolver::record(const vector<signed char> & assignment, weight_t cost) {
+  best_cost = cost;
+  // free columns are left false
+  for (unsigned c = 0; c < val.size(); ++c) best_val[c] = assignment[c] == 1;
+  log(3, "c MCHS: solution of cost %" WGT_FMT "\n", cost);
+
+  if (best_cost <= target_cost || (stop_below_cutoff && best_cost < cutoff_cost))
+    stop = true;
+}
+
+void MCHSSolver::setHeuristic(unsigned c, signed char v) {
+  if (heur_val[c] == v) return;
+  heur_val[c] = v;
+  int lit = 2 * c + (v ? 0 : 1);
+  for (unsigned j = heur_occ_start[lit]; j < heur_occ_start[lit + 1]; ++j)
+    ++heur_count[heur_occ[j]];
+  lit ^= 1;
+  for (unsigned j = heur_occ_start[lit]; j < heur_occ_start[lit + 1]; ++j)
+    --heur_count[heur_occ[j]];
+}
+
+// Lagrangian heuristic on the rows and multipliers of the last
+// lagrangianBound: the columns of negative reduced cost are set true,
+// rows left unsatisfied take their literal of least reduced cost, and
+// then redundant columns are dropped, heaviest first.
+void MCHSSolver::roundLagrangian(weight_t cost) {
+  unsigned n_lits = 2 * val.size();
+  heur_occ_start.assign(n_lits + 1, 0);
+  unsigned n_cons_lits = lag_start[n_lag_cons];
+  for (unsigned j = 0; j < n_cons_lits; ++j) ++heur_occ_start[lag_lits[j] + 1];
+  for (unsigned l = 0; l < n_lits; ++l) heur_occ_start[l + 1] += heur_occ_start[l];
+  heur_occ.resize(n_cons_lits);
+  heur_fill.assign(heur_occ_start.begin(), heur_occ_start.end() - 1);
+  for (unsigned i = 0; i < n_lag_cons; ++i)
+    for (unsigned j = lag_start[i]; j < lag_start[i + 1]; ++j)
+      heur_occ[heur_fill[lag_lits[j]]++] = i;
+
+  // start from all free columns false, where the negative literals hold
+  heur_val = val;
+  heur_count.assign(n_lag_cons, 0);
+  for (unsigned i = 0; i < n_lag_cons; ++i) {
+    for (unsigned j = lag_start[i]; j < lag_start[i + 1]; ++j)
+      heur_count[i] += lag_lits[j] & 1;
+  }
+  for (unsigned c : free_cols) {
+    heur_val[c] = 0;
+    if (lag_best_rc[c] < 0) setHeuristic(c, 1);
+  }
+
+  for (unsigned i = 0; i < n_lag_cons; ++i) {
+    if (heur_count[i]) continue;
+    int pick = -1;
+    double pick_rc = 0;
+    for (unsigned j = lag_start[i]; j < lag_start[i + 1]; ++j) {
+      int l = lag_lits[j];
+      double rc = (l & 1) ? -lag_best_rc[l >> 1] : lag_best_rc[l >> 1];
+      if (pick < 0 || rc < pick_rc) {
+        pick = l;
+        pick_rc = rc;
+      }
+    }
+    setHeuristic(pick >> 1, (pick & 1) ? 0 : 1);
+  }
+
+  heur_cols.clear();
+  for (unsigned c : free_cols)
+    if (heur_val[c] == 1) heur_cols.push_back(c);
+  sort(heur_cols.begin(), heur_cols.end(), [&](unsigned a, unsigned b) {
+    return col_weight[a] > col_weight[b];
+  });
+  for (unsigned c : heur_cols) {
+    bool needed = false;
+    for (unsigned j = heur_occ_start[2 * c]; j < heur_occ_start[2 * c + 1] && !needed; ++j)
+      needed = heur_count[heur_occ[j]] < 2;
+    if (!needed) setHeuristic(c, 0);
+  }
+
+  // a column set false may have broken an earlier row
+  for (unsigned i = 0; i < n_lag_cons; ++i)
+    if (heur_count[i] == 0) return;
+
+  for (unsigned c : free_cols)
+    if (heur_val[c] == 1) cost += col_weight[c];
+  if (cost < best_cost) record(heur_val, cost);
+}
+
+void MCHSSolver::branch(const Bitset & sat, weight_t cost, unsigned k) {
+  vector<int> lits;
+  for (const int * l = cons.begin(k); l != cons.end(k); ++l)
+    if (val[*l >> 1] < 0) lits.push_back(*l);
+
+  // try the literals with the smallest reduced cost first
+  sort(lits.begin(), lits.end(), [&](int a, int b) {
+    return reducedCost(a >> 1) < reducedCost(b >> 1);
+  });
+
+  // the i:th branch makes lits[i] true and lits[0..i-1] false
+  Bitset base = sat;
+  weight_t base_cost = cost;
+  for (int l : lits) {
+    size_t trail_size = trail.size();
+    Bitset child = base;
+    weight_t child_cost = base_cost;
+    assign(l, child, child_cost);
+    search(child, child_cost);
+    undo(trail_size);
+    if (stop) break;
+
+    assign(l ^ 1, base, base_cost);
+    if (base_cost >= best_cost) break;
+  }
+}
+
+// A column set true costs at least its reduced cost (the weight left
+// over by the dual bound) on top of the bound, so columns whose reduced
+// cost closes the gap to the best solution are fixed false. With the
+// Lagrangian bound the same holds for setting a column of negative
+// reduced cost false.
+bool MCHSSolver::fixByReducedCost(Bitset & sat, weight_t & cost, weight_t lb) {
+  weight_t gap = best_cost - cost;
+  bool fixed = false;
+  for (unsigned c = 0; c < val.size(); ++c) {
+    if (val[c] >= 0) continue;
+    double rc = lag_best_rc[c];
+    if ((col_weight[c] > 0 && reducedCost(c) >= gap - lb) ||
+        (rc > 0 && safeBound(lag_bound + rc) >= gap)) {
+      assign(2 * c + 1, sat, cost);
+      fixed = true;
+    } else if (rc < 0 && safeBound(lag_bound - rc) >= gap) {
+      assign(2 * c, sat, cost);
+      fixed = true;
+    }
+  }
+  return fixed;
+}
+
+void MCHSSolver::search(Bitset sat, weight_t cost) {
+  ++nodes;
+  size_t trail_size = trail.size();
+
+  int pick;
+  while (propagate(sat, cost, pick) && cost < best_cost) {
+    if (pick < 0) {
+      record(val, cost);
+      break;
+    }
+    weight_t lb = lowerBound(sat, best_cost - cost);
+    if (lb >= best_cost - cost) break;
+    if (best_cost == numeric_limits<weight_t>::max()) {
+      // the subgradient steps need a solution to aim at
+      lagrangianBound(sat, best_cost - cost, 1);
+      roundLagrangian(cost);
+      if (stop) break;
+    }
+    weight_t lag_lb = lagrangianBound(sat, best_cost - cost, lag_iters);
+    // the multipliers carry over, so later nodes need few iterations
+    lag_iters = NODE_LAG_ITERS;
+    if (lag_lb >= best_cost - cost) break;
+    roundLagrangian(cost);
+    if (stop || max(lb, lag_lb) >= best_cost - cost) break;
+    if (!fixByReducedCost(sat, cost, lb)) {
+      branch(sat, cost, pick);
+      break;
+    }
+  }
+
+  undo(trail_size);
+}
+
+HSSolver::Status MCHSSolver::solve(weight_t target, bool stop_below, weight_t cutoff) {
+  prepare();
+  best_cost = numeric_limits<weight_t>::max();
+  stop = false;
+  target_cost = target;
+  stop_below_cutoff = stop_below;
+  cutoff_cost = cutoff;
+
+  search(Bitset((cons.size() + 63) / 64, 0), 0);
+
+  if (best_cost == numeric_limits<weight_t>::max()) return Status::Failed;
+  // search is complete unless stopped at the cutoff
+  if (stop && best_cost > target_cost) return Status::Feasible;
+  return Status::Optimal;
+}
+
+HSSolver::Status MCHSSolver::solveForHS(vector<int>& hittingSet, weight_t& opt, ProblemInstance *instance) {
+  GlobalConfig & cfg = GlobalConfig::get();
+
+  log(2, "c MCHS: solving hitting set problem\n");
+
+  ++solver_calls;
+  solver_timer.start();
+  hittingSet.clear();
+
+  // the previous optimum is a lower bound, so a solution of that cost
+  // is optimal
+  Status status = solve(cfg.CPLEX_lb_cutoff ? last_opt : 0,
+                        cfg.CPLEX_ub_cutoff, instance->UB);
+
+  solver_timer.stop();
+
+  if (status == Status::Failed) return status;
+
+  for (unsigned c = 0; c < col_var.size(); ++c)
+    if (col_obj[c] && best_val[c]) hittingSet.push_back(col_var[c]);
+
+  sort(hittingSet.begin(), hittingSet.end());
+  log(2, "c MCHS: hitting set:\n");
+  logCore(2, hittingSet);
+
+  opt = best_cost;
+  if (status == Status::Optimal) last_opt = best_cost;
+  solutionExists = true;
+
+  return status;
+}
+
+// Non-optimal hitting set from the greedy dual bound: the variables whose
+// weight was used up hit every constraint without negative literals.
+bool MCHSSolver::LPsolveHS(vector<int>& hittingSet, weight_t& weight) {
+  ++lp_calls;
+  prepare();
+  hittingSet.clear();
+
+  weight = lowerBound(Bitset((cons.size() + 63) / 64, 0),
+                      numeric_limits<weight_t>::max());
+
+  for (unsigned c = 0; c < col_var.size(); ++c)
+    if (col_obj[c] && resid_stamp[c] == stamp && resid[c] == 0)
+      hittingSet.push_back(col_var[c]);
+
+  return true;
+}
+
+bool MCHSSolver::solveForModel(vector<int>& model, weight_t& weight) {
+  log(2, "c MCHS: solving MIP problem\n");
+
+  ++solver_calls;
+  solver_timer.start();
+  Status status = solve(0, false, 0);
+  solver_timer.stop();
+
+  model.clear();
+  if (status == Status::Failed) return false;
+
+  for (unsigned c = 0; c < col_var.size(); ++c)
+    if (!col_obj[c]) model.push_back(best_val[c] ? col_var[c] : -col_var[c]);
+
+  log(3, "c MCHS model\n");
+  logCore(3, model);
+
+  weight = best_cost;
+  solutionExists = true;
+  return true;
+}
+
+void MCHSSolver::exportModel(string file) {
+  ofstream lp(file);
+  condTerminate(!lp.good(), 1, "Error: could not write %s\n", file.c_str());
+
+  lp << "Minimize" << endl << " obj:";
+  for (unsigned c = 0; c < col_var.size(); ++c)
+    if (col_obj[c]) lp << " + " << col_weight[c] << " x" << col_var[c];
+  lp << endl << "Subject To" << endl;
+
+  for (unsigned k = 0; k < cons.size(); ++k) {
+    int negs = 0;
+    lp << " c" << k << ":";
+    for (const int * l = cons.begin(k); l != cons.end(k); ++l) {
+      lp << ((*l & 1) ? " - x" : " + x") << col_var[*l >> 1];
+      negs += *l & 1;
+    }
+    if (cons.clauseSize(k) == 0 && col_var.size()) lp << " 0 x" << col_var[0];
+    lp << " >= " << 1 - negs << endl;
+  }
+
+  lp << "Binary" << endl;
+  for (unsigned c = 0; c < col_var.size(); ++c)
+    lp << " x" << col_var[c] << endl;
+  lp << "End" << endl;
+}
+
+void MCHSSolver::printStats() {
+  log(1, "c Hitting set solver (built-in):\n");
+  log(1, "c   solver calls: %u\n", solver_calls);
+  log(1, "c   search nodes: %lu\n", (unsigned long) nodes);
+  if (lp_calls)
+    log(1, "c   relaxation calls: %u\n", lp_calls);
+  log(1, "c   solver time:  %lu ms\n", solver_timer.cpu_ms_total());
+}
@@ -2,14 +2,13 @@
 #include "Solver.h"
 #include "Util.h"
 #include "VarMapper.h"
+#include "WCNFParser.h"
 #include "Timer.h"
 
 #include <stdlib.h>
 #include <signal.h>
 #include <stdio.h>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <iomanip>
 
@@ -28,11 +27,7 @@ void stop(int) {
 void stop_incomplete(int) {
   if (maxsat_solver && varmap) {
 
-    stringstream internal_model;
-    internal_model << setprecision(GlobalConfig::get().streamPrecision);
-    maxsat_solver->instance.printSolution(internal_model);
-
-    varmap->unmap(internal_model, cout);
+    maxsat_solver->instance.printSolution(cout);
 
     fflush(stdout);
     maxsat_solver->printStats();
@@ -73,33 +68,34 @@ int main(int argc, const char* argv[]) {
   log(1, "c git commit date " GITDATE "\n");
 #endif
 
-  ifstream file(argv[1]);
-  
-  if (file.fail()) {
-    printf("Could not open file %s\n", argv[1]);
-    exit(1);
-  }
+  Timer parse_timer;
+  parse_timer.start();
 
+  // variables are renumbered during parsing
   varmap = new VarMapper();
-  stringstream mapped;
-  mapped << setprecision(cfg.streamPrecision);
-  varmap->map(file, mapped);
-
-  ProblemInstance instance(mapped, cout);
 
+  ProblemInstance instance(cout);
+  instance.varmap = varmap;
   instance.filename = string(argv[1]);
 
-  maxsat_solver = new Solver(instance, cout);
+  if (cfg.instanceCache.empty() || !instance.loadCache(cfg.instanceCache)) {
+    WCNFData wcnf;
+    if (!parseWCNFFile(argv[1], wcnf, varmap)) {
+      printf("Could not open file %s\n", argv[1]);
+      exit(1);
+    }
+    cout << "c top " << wcnf.top << endl;
+    instance.load(wcnf);
+  }
 
-  file.close();
+  parse_timer.stop();
+  instance.parse_timer.add(parse_timer);
 
-  maxsat_solver->solve();
+  maxsat_solver = new Solver(instance, cout);
 
-  stringstream internal_model;
-  internal_model << setprecision(cfg.streamPrecision);
-  instance.printSolution(internal_model);
+  maxsat_solver->solve();
 
-  varmap->unmap(internal_model, cout);
+  instance.printSolution(cout);
   
   if (cfg.printStats) {
     maxsat_solver->printStats();
@@ -11,8 +11,12 @@ MinisatSolver::MinisatSolver()
       sat_calls(0),
       unsat_calls(0),
       hasModel(false),
+      avg_conflicts(0),
       cfg(GlobalConfig::get()),
-      minisat(new Minisat::Solver()) {
+      minisat(new Minisat::Solver()),
+      assume_bvars(false),
+      first_changed(0),
+      only_mode(none) {
 
   setFPU();
   minisat->verbosity = cfg.SAT_verbosity;
@@ -22,6 +26,7 @@ MinisatSolver::MinisatSolver()
   minisat->random_seed = cfg.SAT_rndSeed;
   minisat->ccmin_mode = cfg.SAT_ccMinMode;
   minisat->phase_saving = cfg.SAT_phaseSaving;
+  minisat->trail_saving = cfg.SAT_trailSaving;
   minisat->rnd_init_act = cfg.SAT_rndInitActivity;
   minisat->garbage_frac = cfg.SAT_gcFrac;
   minisat->luby_restart = cfg.SAT_lubyRestart;
@@ -75,23 +80,29 @@ void MinisatSolver::findCores(vector<vector<int>>& out_cores)
   getConflicts(out_cores);
 }
 
-bool MinisatSolver::findCoreLimited(std::vector<int>& )
+// like findCore, but returns false without a core or a model if the
+// budgets set by setBudgets run out
+bool MinisatSolver::findCoreLimited(vector<int>& out_core)
 {
-  printf("findCoreLimited unimplemented\n");
-  exit(1);
-  return false;
-
-  /*
+  log(3, "c MinisatSolver::findCoreLimited\n");
   out_core.clear();
   Minisat::lbool res = solveLimited();
-  
-  if (res == Minisat::l_Undef) // Hit resource cap
+  hasModel = res == Minisat::l_True;
+
+  if (res == Minisat::l_Undef) {
+    log(3, "c out of budget\n");
     return false;
-  else if (res == Minisat::l_False) // UNSAT -> fetch conflict
-    getConflict(out_core);
-  // else: SAT -> no core
+  }
+
+  vector<vector<int>> cores;
+  getConflicts(cores);
+
+  if (cores.size()) {
+    out_core = cores[0];
+    log(3, "c found core (size %lu)\n", out_core.size());
+    logCore(3, out_core);
+  }
   return true;
-  */
 }
 
 // solve instance with current assumptions, return SAT?
@@ -103,8 +114,10 @@ bool MinisatSolver::_solve()
 
   //cout << "c assumptions " << assumptions << endl;
 
-  bool ret = minisat->solve(assumptions);
+  uint64_t conflicts = minisat->conflicts;
+  bool ret = minisat->solve(currentAssumptions());
   log(3, "c Minisat retcode %d\n", ret);
+  countConflicts(minisat->conflicts - conflicts);
 
   condLog(!minisat->okay(), 1, "c MiniSat in conflicting state\n");
 
@@ -130,7 +143,9 @@ Minisat::lbool MinisatSolver::solveLimited()
   Timer timer; 
   timer.start();
 
-  Minisat::lbool ret = minisat->solveLimited(assumptions);
+  uint64_t conflicts = minisat->conflicts;
+  Minisat::lbool ret = minisat->solveLimited(currentAssumptions());
+  countConflicts(minisat->conflicts - conflicts);
 
   timer.stop();
 
@@ -139,7 +154,7 @@ Minisat::lbool MinisatSolver::solveLimited()
   if (ret == Minisat::l_True) {
     ++sat_calls;
     sat_timer.add(timer);
-  } else {
+  } else if (ret == Minisat::l_False) {
     ++unsat_calls;
     unsat_timer.add(timer);
   }
@@ -147,15 +162,77 @@ Minisat::lbool MinisatSolver::solveLimited()
   return ret;
 }
 
+const Minisat::vec<Minisat::Lit> & MinisatSolver::currentAssumptions()
+{
+  if (!assume_bvars) return assumptions;
+
+  reorderBvarAssumptions();
+  if (!assumptions.size()) return bvar_assumptions;
+
+  all_assumptions.clear();
+  assumptions.copyTo(all_assumptions);
+  for (int i = 0; i < bvar_assumptions.size(); ++i)
+    all_assumptions.push(bvar_assumptions[i]);
+  return all_assumptions;
+}
+
+// Move the bvars that changed polarity since the last call after the
+// others, keeping the order within both. The unchanged ones before the
+// first change stay where they are.
+void MinisatSolver::reorderBvarAssumptions()
+{
+  int n = bvar_assumptions.size();
+  if (first_changed >= n) return;
+
+  vector<Minisat::Lit> moved;
+  int j = first_changed;
+  for (int i = first_changed; i < n; ++i) {
+    if (changed[i]) {
+      moved.push_back(bvar_assumptions[i]);
+      changed[i] = 0;
+    } else {
+      bvar_assumptions[j++] = bvar_assumptions[i];
+    }
+  }
+  for (Minisat::Lit l : moved) bvar_assumptions[j++] = l;
+
+  for (int i = first_changed; i < n; ++i)
+    var_assumptionIdx[var(bvar_assumptions[i])] = i;
+  first_changed = n;
+}
+
+void MinisatSolver::setOnly(const vector<int>& bvars, bool relax)
+{
+  if (only_mark.size() < var_assumptionIdx.size())
+    only_mark.resize(var_assumptionIdx.size(), 0);
+  for (int b : bvars) only_mark[b] = 1;
+
+  if (only_mode != (relax ? relax_only : activate_only)) {
+    for (int i = 0; i < bvar_assumptions.size(); ++i)
+      if (!only_mark[var(bvar_assumptions[i])]) relaxAt(i, !relax);
+  } else {
+    // only the bvars of the previous call differ from !relax
+    for (int b : only_bvars)
+      if (!only_mark[b] && var_assumptionIdx[b] >= 0) relaxAt(var_assumptionIdx[b], !relax);
+  }
+
+  for (int b : bvars) {
+    relaxAt(bvarIdx(b), relax);
+    only_mark[b] = 0;
+  }
+  only_bvars = bvars;
+  only_mode = relax ? relax_only : activate_only;
+}
+
 void MinisatSolver::getConflicts(vector<vector<int>>& out_cores) 
 {
-  log(3, "c minisat %d cores\n", minisat->out_conflicts.size());  
+  log(3, "c minisat %d cores\n", minisat->nCores());  
   out_cores.clear();
 
-  for (int i = 0; i < minisat->out_conflicts.size(); ++i) {
+  for (int i = 0; i < minisat->nCores(); ++i) {
 
-    const Minisat::vec<Minisat::Lit>& conflict = minisat->out_conflicts[i]->toVec();
-    int conflict_size = conflict.size();
+    const Minisat::Lit * conflict = minisat->coreLits(i);
+    int conflict_size = minisat->coreSize(i);
 
     vector<int> out_core;
     out_core.resize(conflict_size);
@@ -171,14 +248,6 @@ void MinisatSolver::getConflicts(vector<vector<int>>& out_cores)
   sort(out_cores.begin(), out_cores.end(),
          [] (const vector<int> &a, const vector<int> &b) { return a.size() < b.size(); } );
 
-  // clear conflicts
-  for (int i = 0; i < minisat->out_conflicts.size(); ++i) {
-    minisat->out_conflicts[i]->clear();
-    delete minisat->out_conflicts[i];
-  }
-
-  minisat->out_conflicts.clear();
-
   while(out_cores.size() && out_cores.size() > unsigned(cfg.shuffle_coreLimit)) 
       out_cores.pop_back();
 
@@ -203,10 +272,15 @@ int MinisatSolver::newVar() {
 
 bool MinisatSolver::addConstraint(vector<int>& constr) 
 {
-  Minisat::vec<Minisat::Lit> minisat_clause(constr.size());
-  for (unsigned i = 0; i < constr.size(); ++i) {
-    int v = abs(constr[i]);
-    bool s = constr[i] < 0;
+  return addConstraint(constr.data(), constr.data() + constr.size());
+}
+
+bool MinisatSolver::addConstraint(const int * begin, const int * end)
+{
+  Minisat::vec<Minisat::Lit> minisat_clause(end - begin);
+  for (int i = 0; begin + i != end; ++i) {
+    int v = abs(begin[i]);
+    bool s = begin[i] < 0;
     Minisat::Lit l = s ? ~Minisat::mkLit(v) : Minisat::mkLit(v);
     minisat_clause[i] = l;
   }
@@ -225,13 +299,13 @@ void MinisatSolver::getModel(vector<bool>& model)
     model[i] = (minisat->model[i] == Minisat::l_True);
 }
 
-weight_t MinisatSolver::getModelWeight(std::unordered_map<int, weight_t>& bvar_weights) {
+weight_t MinisatSolver::getModelWeight(const BvarTable& bvars) {
 
   condTerminate(minisat->model.size() == 0, 1, "c MinisatSolver::getModelWeight: no model exists\n");
 
   weight_t opt = 0;
-  for (auto kv : bvar_weights)
-    if (minisat->model[kv.first] == Minisat::l_True) opt += kv.second;
+  for (unsigned i = 0; i < bvars.size(); ++i)
+    if (minisat->model[bvars.var(i)] == Minisat::l_True) opt += bvars.weight(i);
   return opt;
 }
 
@@ -243,6 +317,9 @@ void MinisatSolver::printStats(const char* solver_name) {
   log(1, "c %s solver time:  %lu ms\n", solver_name, solver_timer.cpu_ms_total());
   log(1, "c %s sat time:     %lu ms\n", solver_name, sat_timer.cpu_ms_total());
   log(1, "c %s unsat time:   %lu ms\n", solver_name, unsat_timer.cpu_ms_total());
+  if (minisat->trail_saving) {
+    log(1, "c %s reused levels: %lu\n", solver_name, minisat->reused_levels);
+  }
   if (minisat->do_shuffle) {
     log(1, "c %s shuffle time: %.2fs\n", solver_name, float(minisat->shuffle_time) / 1000000.0);
   }
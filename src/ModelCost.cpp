@@ -0,0 +1,111 @@
+#include <cstdlib>  // abs
+
+#include "ModelCost.h"
+
+using namespace std;
+
+ModelCost::ModelCost(const ClauseArena & clauses, const BvarTable & bvars)
+  : clauses(clauses), bvars(bvars), built(false), exact(true), cost(0) { }
+
+void ModelCost::build() {
+  owner.assign(clauses.size(), -1);
+  for (unsigned i = 0; i < bvars.size(); ++i)
+    for (unsigned id : bvars.clauses(i))
+      owner[id] = i;
+
+  int n_vars = 0;
+  for (unsigned i = 0; i < bvars.size(); ++i)
+    n_vars = max(n_vars, bvars.var(i));
+
+  exact = true;
+  for (unsigned id = 0; id < clauses.size(); ++id) {
+    if (owner[id] < 0) continue;
+    for (const int * l = clauses.begin(id); l != clauses.end(id); ++l) {
+      n_vars = max(n_vars, abs(*l));
+      if (bvars.contains(abs(*l))) exact = false;
+    }
+  }
+  ++n_vars;
+
+  // occurrence lists in a single array
+  occ_start.assign(2 * n_vars + 1, 0);
+  for (unsigned id = 0; id < clauses.size(); ++id) {
+    if (owner[id] < 0) continue;
+    for (const int * l = clauses.begin(id); l != clauses.end(id); ++l)
+      occ_start[2 * abs(*l) + (*l < 0) + 1]++;
+  }
+  for (unsigned l = 1; l < occ_start.size(); ++l)
+    occ_start[l] += occ_start[l - 1];
+
+  occ.resize(occ_start.back());
+  vector<unsigned> fill(occ_start.begin(), occ_start.end() - 1);
+  for (unsigned id = 0; id < clauses.size(); ++id) {
+    if (owner[id] < 0) continue;
+    for (const int * l = clauses.begin(id); l != clauses.end(id); ++l)
+      occ[fill[2 * abs(*l) + (*l < 0)]++] = id;
+  }
+
+  // start from the all-false assignment, where exactly the
+  // negative literals are satisfied and no bvar is active
+  value.assign(n_vars, false);
+  sat_count.assign(clauses.size(), 0);
+  unsat_clauses.assign(bvars.size(), 0);
+  for (unsigned id = 0; id < clauses.size(); ++id) {
+    if (owner[id] < 0) continue;
+    for (const int * l = clauses.begin(id); l != clauses.end(id); ++l)
+      if (*l < 0) sat_count[id]++;
+    if (sat_count[id] == 0) unsat_clauses[owner[id]]++;
+  }
+  cost = 0;
+
+  built = true;
+}
+
+void ModelCost::setLit(int lit, bool val) {
+  for (unsigned k = occ_start[lit]; k < occ_start[lit + 1]; ++k) {
+    unsigned id = occ[k];
+    int i = owner[id];
+    if (val) {
+      if (sat_count[id]++ == 0 && --unsat_clauses[i] == 0 && value[bvars.var(i)])
+        cost -= bvars.weight(i);
+    } else {
+      if (--sat_count[id] == 0 && unsat_clauses[i]++ == 0 && value[bvars.var(i)])
+        cost += bvars.weight(i);
+    }
+  }
+}
+
+void ModelCost::flip(int var, bool val) {
+  value[var] = val;
+  setLit(2 * var, val);
+  setLit(2 * var + 1, !val);
+
+  // bvars do not occur in the clauses, so the clause counts
+  // are not affected by the bvar itself
+  int i = bvars.index(var);
+  if (i >= 0 && unsat_clauses[i] > 0) {
+    if (val) cost += bvars.weight(i);
+    else     cost -= bvars.weight(i);
+  }
+}
+
+bool ModelCost::evaluate(const vector<bool> & model, weight_t & out_cost) {
+  if (!built) build();
+  if (!exact) return false;
+
+  for (unsigned v = 1; v < value.size(); ++v) {
+    bool val = v < model.size() && model[v];
+    if (val != value[v]) flip(v, val);
+  }
+
+#if defined(FLOAT_WEIGHTS)
+  // avoid accumulating rounding errors over many updates
+  cost = 0;
+  for (unsigned i = 0; i < bvars.size(); ++i)
+    if (unsat_clauses[i] > 0 && value[bvars.var(i)])
+      cost += bvars.weight(i);
+#endif
+
+  out_cost = cost;
+  return true;
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+
+#include "ModelRotation.h"
+
+using namespace std;
+
+ModelRotation::ModelRotation(const ClauseArena & clauses, const BvarTable & bvars)
+    : clauses(clauses),
+      bvars(bvars),
+      n_clauses(0) { }
+
+void ModelRotation::sync() {
+  for (; n_clauses < clauses.size(); ++n_clauses) {
+    for (const int * l = clauses.begin(n_clauses); l != clauses.end(n_clauses); ++l) {
+      // room for both polarities
+      if (index(*l) >= occurs.size()) occurs.resize(2 * abs(*l) + 2);
+      occurs[index(*l)].push_back(n_clauses);
+    }
+  }
+}
+
+bool ModelRotation::satisfied(const vector<bool> & model, unsigned id) const {
+  for (const int * l = clauses.begin(id); l != clauses.end(id); ++l)
+    if (value(model, *l)) return true;
+  return false;
+}
+
+bool ModelRotation::relaxable(const vector<bool> & model, const VarFlags & in_core,
+                              const vector<unsigned> & ids, int & d) const {
+  for (unsigned id : ids) {
+    if (satisfied(model, id)) continue;
+
+    int b = 0;
+    for (const int * l = clauses.begin(id); l != clauses.end(id); ++l) {
+      if (*l > 0 && in_core[*l] && (!d || *l == d)) {
+        b = *l;
+        break;
+      }
+    }
+    // a hard clause, or a soft clause of another member
+    if (!b) return false;
+    d = b;
+  }
+  return true;
+}
+
+int ModelRotation::falsified(vector<bool> model, const vector<int> & core) const {
+  if (model.size() < occurs.size() / 2) model.resize(occurs.size() / 2, false);
+
+  VarFlags in_core;
+  for (int b : core) {
+    in_core.set(b);
+    if (index(b) < occurs.size()) model[b] = false;
+  }
+
+  int d = 0;
+  for (int b : core)
+    if (index(b) < occurs.size() && !relaxable(model, in_core, occurs[index(b)], d))
+      return 0;
+  if (!d) return 0;
+
+  model[d] = true;
+  for (unsigned id : occurs[index(-d)])
+    if (!satisfied(model, id)) return 0;
+  return d;
+}
+
+void ModelRotation::rotate(vector<bool> model, int c, const vector<int> & core,
+                           vector<int> & critical, bool recursive) const {
+  if (index(c) >= occurs.size()) return;
+  if (model.size() < occurs.size() / 2) model.resize(occurs.size() / 2, false);
+
+  // members of the core other than c may be relaxed in a model that
+  // falsified found, rotation starts from one with their bvars false
+  VarFlags in_core;
+  for (int b : core) {
+    in_core.set(b);
+    if (b != c && index(b) < occurs.size()) model[b] = false;
+  }
+
+  vector<int> found(1, c);
+  rotateFrom(model, c, in_core, found, recursive);
+
+  for (unsigned i = 1; i < found.size(); ++i)
+    if (find(critical.begin(), critical.end(), found[i]) == critical.end())
+      critical.push_back(found[i]);
+}
+
+void ModelRotation::rotateFrom(vector<bool> & model, int c, const VarFlags & in_core,
+                               vector<int> & found, bool recursive) const {
+  bool c_value = model[c];
+
+  // the model must end up satisfying every clause with c, so the
+  // literals to flip come from the first falsified one. 0 flips none,
+  // which is enough when c labels hard clauses, as after preprocessing.
+  model[c] = false;
+  const vector<unsigned> & soft = occurs[index(c)];
+  vector<int> flips(1, 0);
+  for (unsigned id : soft) {
+    if (satisfied(model, id)) continue;
+    for (const int * l = clauses.begin(id); l != clauses.end(id); ++l)
+      if (*l != c && !bvars.contains(abs(*l))) flips.push_back(*l);
+    break;
+  }
+
+  for (int l : flips) {
+    if (l) model[abs(l)] = l > 0;
+
+    int d = 0;
+    if ((!l || relaxable(model, in_core, occurs[index(-l)], d)) &&
+        relaxable(model, in_core, soft, d) && d && d != c) {
+      // relaxing d must not falsify anything else
+      model[d] = true;
+      bool sat = true;
+      for (unsigned id : occurs[index(-d)])
+        if (!(sat = satisfied(model, id))) break;
+
+      if (sat && find(found.begin(), found.end(), d) == found.end()) {
+        found.push_back(d);
+        // the model now falsifies the clauses of d instead of c
+        if (recursive) rotateFrom(model, d, in_core, found, recursive);
+      }
+      model[d] = false;
+    }
+
+    if (l) model[abs(l)] = l < 0;
+  }
+
+  model[c] = c_value;
+}
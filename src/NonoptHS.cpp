@@ -1,171 +1,128 @@
-#include <algorithm>  // std::sort, std::reverse, std::count
+#include <algorithm>  // std::sort, std::any_of
 #include <cmath>
+#include <memory>
 
 #include "NonoptHS.h"
+#include "GreedyHS.h"
 #include "Util.h"
 
 using namespace std;
 
 namespace NonoptHS {
 
+namespace {
+
+// A hitting set with a flag for each of its bvars, so that adding a bvar
+// or testing a core takes time linear in the size of the core.
+class HittingSet {
+ public:
+  HittingSet(vector<int>& hs) : hs(hs) {
+    for (int b : hs) in_hs.set(b);
+  }
+
+  bool hits(const vector<int>& core) const {
+    return any_of(core.begin(), core.end(), [&](int b) { return in_hs[b]; });
+  }
+
+  void add(int b) {
+    if (in_hs[b]) return;
+    in_hs.set(b);
+    hs.push_back(b);
+  }
+
+ private:
+  vector<int>& hs;
+  VarFlags in_hs;
+};
+
+// new_cores are not minimized, so they may have bvars of no core yet
+unsigned countOf(const vector<unsigned>& coreClauseCounts, int v) {
+  return unsigned(v) < coreClauseCounts.size() ? coreClauseCounts[v] : 0;
+}
+
+}
+
 void _frac(double f, vector<int>& out_hs, const vector<vector<int>>& new_cores,
-          const unordered_map<int, unsigned>& coreClauseCounts) {
+          const vector<unsigned>& coreClauseCounts) {
   log(2, "NonoptHS: frac\n");
 
-  for (auto core : new_cores) {
-    vector<pair<int, int>> cts_vars;
-    unsigned take = (int)ceil(core.size() * f);
-
-    for (auto c : core)
-      if (count(out_hs.begin(), out_hs.end(), c))
-        goto skip;  // core already hit by out_hs
+  HittingSet hs(out_hs);
+  vector<pair<unsigned, int>> cts_vars;
+  for (const vector<int>& core : new_cores) {
+    if (hs.hits(core)) continue;
 
-    for (int v : core) cts_vars.push_back(make_pair(coreClauseCounts.at(v), v));
+    unsigned take = (int)ceil(core.size() * f);
+    cts_vars.clear();
+    for (int v : core) cts_vars.push_back(make_pair(countOf(coreClauseCounts, v), v));
     sort(cts_vars.begin(), cts_vars.end());
     for (auto& occ_var : cts_vars) {
       if (!take) break;
-      out_hs.push_back(occ_var.second);
+      hs.add(occ_var.second);
       --take;
     }
-
-  skip: continue;
   }
 }
 
 void _disjoint(vector<int>& out_hs, const vector<vector<int>>& new_cores) {
   log(2, "NonoptHS: disjoint\n");
 
-  for (auto core : new_cores)
-    for (int v : core)
-      if (!count(out_hs.begin(), out_hs.end(), v)) out_hs.push_back(v);
+  HittingSet hs(out_hs);
+  for (const vector<int>& core : new_cores)
+    for (int v : core) hs.add(v);
 }
 
 void _common(vector<int>& out_hs, const vector<vector<int>>& new_cores,
-            const unordered_map<int, unsigned>& coreClauseCounts) {
+            const vector<unsigned>& coreClauseCounts) {
   log(2, "NonoptHS: common\n");
 
-  for (auto core : new_cores) {
+  HittingSet hs(out_hs);
+  for (const vector<int>& core : new_cores) {
+    if (hs.hits(core)) continue;
+
     int maxVar = -1;
     unsigned maxCount = 0;
-    for (auto c : core)
-      if (count(out_hs.begin(), out_hs.end(), c))
-        goto skip;  // core already hit by out_hs
-
     for (int v : core) {
-      if (coreClauseCounts.at(v) > maxCount) {
+      if (countOf(coreClauseCounts, v) > maxCount) {
         maxVar = v;
-        maxCount = coreClauseCounts.at(v);
+        maxCount = countOf(coreClauseCounts, v);
       }
     }
 
     if (maxVar != -1)
-      out_hs.push_back(maxVar);
-
-  skip: continue;
+      hs.add(maxVar);
   }
 }
 
-//
-// Greedy algorithm for minimum cost hitting set.
-//
-void _greedy(vector<int>& out_hs, const vector<vector<int>>& cores,
-            const unordered_map<int, weight_t>& weights,
-            const unordered_map<int, unsigned>& coreClauseCounts) {
-  log(2, "NonoptHS: greedy\n");
-
-  // keep track of the number of occurrences of each variable in the cores
-  // and also the variable weight, to reduce lookups
-  unordered_map<int, pair<int, weight_t>> var_count_weight;
-
-  // remember which cores each variable occurs in
-  unordered_map<int, vector<int>> var_cores;
-
-  out_hs.clear();
-
-  log(2, "c finding greedy hitting set of %ld cores\n", cores.size());
+static unsigned cores_generation = 0;
 
-  for (unsigned i = 0; i < cores.size(); ++i) {
-    for (int v : cores[i]) {
-      if (var_cores.find(v) == var_cores.end()) {
-        var_cores[v] = vector<int>();
-        var_count_weight[v] = make_pair(coreClauseCounts.at(v), weights.at(v));
-      }
-      var_cores[v].push_back(i);
-    }
-  }
-
-  // keep track of which cores are hit by the current vector hs
-  vector<bool> hit(cores.size(), false);
-
-  unsigned unhits = cores.size();
-  weight_t weight = 0;
-
-  // repeat until all cores are hit
-  while (unhits) {
-
-    // find the variable v with lowest (weight / #occurrences)
-    int v = -1;
-    double o = std::numeric_limits<double>::max();
-    weight_t w = WEIGHT_MAX;
-
-    for (auto& e : var_count_weight) {
-      int count = e.second.first;
-      weight_t wt = e.second.second;
-      double _o = ((double)wt / (double)count);
-      if (count != 0 && _o < o) {
-        o = _o;
-        w = wt;
-        v = e.first;
-      }
-    }
-
-    weight += w;
-
-    // update variable counts
-    for (int c : var_cores[v]) {
-      // if that core hasn't been hit yet
-      if (!hit[c]) {
-        // for each variable in the core, decrement occurrences
-        for (int b : cores[c]) {
-          var_count_weight[b].first -= 1;
-        }
-      }
-    }
-
-    // track hit cores
-    for (int c : var_cores[v]) {
-      if (!hit[c]) {
-        hit[c] = true;
-        --unhits;
-      }
-    }
-
-    out_hs.push_back(v);
-  }
-
-  log(2, "c found greedy hs with cost %" WGT_FMT "\n", weight);
+void coresChanged() {
+  ++cores_generation;
 }
 
 void common(vector<int>& out_hs, 
            const vector<vector<int>>& new_cores,
            const vector<vector<int>>&,
-           const unordered_map<int, weight_t>&,
-           const unordered_map<int, unsigned>& coreClauseCounts) {
+           const BvarTable&,
+           const vector<unsigned>& coreClauseCounts) {
   _common(out_hs, new_cores, coreClauseCounts);
 }
 
-void greedy(vector<int>& out_hs, 
-           const vector<vector<int>>&,
-           const vector<vector<int>>& cores,
-           const unordered_map<int, weight_t>& weights,
-           const unordered_map<int, unsigned>& coreClauseCounts) {
-  _greedy(out_hs, cores, weights, coreClauseCounts);
+NonOptHSFunc greedy() {
+  shared_ptr<GreedyHS> hs_solver = make_shared<GreedyHS>();
+  unsigned generation = cores_generation;
+  return [=](vector<int>& out_hs, const vector<vector<int>>&,
+             const vector<vector<int>>& cores, const BvarTable& weights,
+             const vector<unsigned>&) mutable {
+    log(2, "NonoptHS: greedy\n");
+    hs_solver->solve(out_hs, cores, weights, generation != cores_generation);
+    generation = cores_generation;
+  };
 }
 
 NonOptHSFunc frac(double fracSize) {
-  return [&](vector<int>& out_hs, const vector<vector<int>>& new_cores,
-             const vector<vector<int>>&, const unordered_map<int, weight_t>&,
-             const unordered_map<int, unsigned>& coreClauseCounts) {
+  return [=](vector<int>& out_hs, const vector<vector<int>>& new_cores,
+             const vector<vector<int>>&, const BvarTable&,
+             const vector<unsigned>& coreClauseCounts) {
     _frac(fracSize, out_hs, new_cores, coreClauseCounts);
   };
 }
@@ -173,8 +130,8 @@ NonOptHSFunc frac(double fracSize) {
 void disjoint(vector<int>& out_hs, 
            const vector<vector<int>>& new_cores,
            const vector<vector<int>>&,
-           const unordered_map<int, weight_t>&,
-           const unordered_map<int, unsigned>&) {
+           const BvarTable&,
+           const vector<unsigned>&) {
   _disjoint(out_hs, new_cores);
 }
 
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <random>
+
+#include "Portfolio.h"
+#include "ProblemInstance.h"
+#include "GlobalConfig.h"
+#include "Util.h"
+
+using namespace std;
+
+Portfolio::Portfolio(ProblemInstance & instance, unsigned n_workers)
+    : instance(instance),
+      stopping(false),
+      hs_version(0),
+      core_pool(nullptr) {
+
+  // load all solvers before the threads start, as the
+  // main thread goes on to change the instance
+  for (unsigned i = 0; i < n_workers; ++i) {
+    Worker * w = new Worker;
+    w->id = i + 1;
+    w->interruptible = false;
+    w->solver = new MinisatSolver();
+    configure(*w);
+    // nothing to refute if the clauses alone are unsatisfiable
+    if (!instance.loadClauses(w->solver)) {
+      delete w->solver;
+      delete w;
+      break;
+    }
+    workers.push_back(w);
+  }
+
+  if (GlobalConfig::get().modelRotation) instance.rotation.sync();
+
+  for (Worker * w : workers)
+    w->thread = thread(&Portfolio::run, this, ref(*w));
+
+  log(1, "c portfolio: started %lu workers\n", workers.size());
+}
+
+Portfolio::~Portfolio() {
+  stop();
+
+  for (Worker * w : workers) {
+    delete w->solver;
+    delete w;
+  }
+
+  CoreNode * node = core_pool.exchange(nullptr);
+  while (node) {
+    CoreNode * next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
+// worker 0 would be the main thread with the configured parameters
+void Portfolio::configure(Worker & w) {
+  GlobalConfig & cfg = GlobalConfig::get();
+  unsigned i = w.id;
+
+  w.solver->setRandomSeed(cfg.SAT_rndSeed + i);
+  w.solver->setRandomInitActivity(true);
+  w.solver->setRandomFreq(i % 2 ? 0.02 : cfg.SAT_rndFreq);
+  w.solver->setVarDecay(i % 3 == 1 ? 0.9 : i % 3 == 2 ? 0.99 : cfg.SAT_varDecay);
+  w.solver->setPhaseSaving(i % 4 == 2 ? 0 : cfg.SAT_phaseSaving);
+  w.solver->setLubyRestart(i % 4 == 3 ? !cfg.SAT_lubyRestart : cfg.SAT_lubyRestart);
+
+  // cardinality minimization adds variables to the
+  // instance, so it is left to the main thread
+  static const MinimizeAlgorithm algs[] = { destructive, binary, constructive };
+  w.minAlg = algs[(i - 1) % 3];
+}
+
+void Portfolio::run(Worker & w) {
+  GlobalConfig & cfg = GlobalConfig::get();
+  mt19937 rng(cfg.randomSeed + w.id);
+
+  vector<int> round_hs;
+  vector<int> core;
+  unsigned version = 0;
+
+  for (;;) {
+    {
+      unique_lock<mutex> lock(hs_mutex);
+      hs_changed.wait(lock, [&] { return stopping || hs_version != version; });
+      if (stopping) return;
+      round_hs = hs;
+      version = hs_version;
+    }
+
+    // extend the hitting set until the instance is satisfiable,
+    // or until the main thread publishes a new one
+    for (;;) {
+      w.solver->relaxOnly(round_hs);
+      w.solver->clearAssumptions();
+      w.solver->assumeBvars();
+
+      if (!findCore(w, core)) return;
+      if (core.empty()) {
+        instance.offerModel(w.solver);
+        break;
+      }
+
+      if (cfg.doRerefuteCores)
+        instance.reduceCore(core, MinimizeAlgorithm::rerefute, w.solver);
+      if (cfg.doMinimizeCores)
+        instance.reduceCore(core, w.minAlg, w.solver);
+
+      // odd workers add a random bvar of each core, even
+      // workers the whole core as in --nonopt disjoint
+      if (w.id % 2)
+        round_hs.push_back(core[rng() % core.size()]);
+      else
+        round_hs.insert(round_hs.end(), core.begin(), core.end());
+
+      pushCore(core);
+
+      if (stopping) return;
+      lock_guard<mutex> lock(hs_mutex);
+      if (hs_version != version) break;
+    }
+  }
+}
+
+bool Portfolio::findCore(Worker & w, vector<int> & core) {
+  {
+    lock_guard<mutex> lock(w.interrupt_mutex);
+    if (stopping) return false;
+    w.interruptible = true;
+  }
+
+  w.solver->findCore(core);
+
+  lock_guard<mutex> lock(w.interrupt_mutex);
+  w.interruptible = false;
+  return !stopping;
+}
+
+void Portfolio::pushCore(vector<int> & core) {
+  CoreNode * node = new CoreNode;
+  node->core.swap(core);
+  sort(node->core.begin(), node->core.end());
+
+  node->next = core_pool.load(memory_order_relaxed);
+  while (!core_pool.compare_exchange_weak(node->next, node,
+                                          memory_order_release,
+                                          memory_order_relaxed)) { }
+}
+
+void Portfolio::stop() {
+  {
+    lock_guard<mutex> lock(hs_mutex);
+    stopping = true;
+  }
+  hs_changed.notify_all();
+
+  // minimization is never interrupted, an interrupted solve would
+  // look like a satisfiable subset of the core
+  for (Worker * w : workers) {
+    lock_guard<mutex> lock(w->interrupt_mutex);
+    if (w->interruptible) w->solver->interrupt();
+  }
+
+  for (Worker * w : workers)
+    if (w->thread.joinable()) w->thread.join();
+}
+
+void Portfolio::publish(const vector<int> & new_hs) {
+  {
+    lock_guard<mutex> lock(hs_mutex);
+    hs = new_hs;
+    ++hs_version;
+  }
+  hs_changed.notify_all();
+}
+
+void Portfolio::collectCores(vector<vector<int>> & out) {
+  out.clear();
+
+  // the stack has the newest core first
+  CoreNode * node = core_pool.exchange(nullptr, memory_order_acquire);
+  while (node) {
+    if (collected.insert(node->core).second)
+      out.push_back(move(node->core));
+    CoreNode * next = node->next;
+    delete node;
+    node = next;
+  }
+  reverse(out.begin(), out.end());
+}
@@ -5,7 +5,9 @@
 #include <cassert>
 
 #include "ProblemInstance.h"
+#include "CoreMinimizer.h"
 #include "WCNFParser.h"
+#include "InstanceCache.h"
 
 using namespace std;
 
@@ -22,8 +24,13 @@ ProblemInstance::ProblemInstance(ostream& out)
       sat_solver(nullptr),
       mip_solver(nullptr),
       muser(nullptr),
+      rotation(clauses, bvars),
       max_var(0),
       fixed_variables(0),
+      varmap(nullptr),
+      cost_eval(bvar_clauses, bvars),
+      offered_UB(numeric_limits<weight_t>::max()),
+      preprocessor(nullptr),
       out(out)
 {
 }
@@ -36,8 +43,13 @@ ProblemInstance::ProblemInstance(unsigned nClauses, weight_t top, weight_t* weig
       sat_solver(nullptr),
       mip_solver(nullptr),
       muser(nullptr),
+      rotation(clauses, bvars),
       max_var(0),
       fixed_variables(0),
+      varmap(nullptr),
+      cost_eval(bvar_clauses, bvars),
+      offered_UB(numeric_limits<weight_t>::max()),
+      preprocessor(nullptr),
       out(out)
 {
   vector<vector<int>> tmp_clauses;
@@ -73,8 +85,13 @@ ProblemInstance::ProblemInstance(istream& wcnf_in, ostream& out)
       sat_solver(nullptr),
       mip_solver(nullptr),
       muser(nullptr),
+      rotation(clauses, bvars),
       max_var(0),
       fixed_variables(0),
+      varmap(nullptr),
+      cost_eval(bvar_clauses, bvars),
+      offered_UB(numeric_limits<weight_t>::max()),
+      preprocessor(nullptr),
       out(out)
 {
 
@@ -83,23 +100,45 @@ ProblemInstance::ProblemInstance(istream& wcnf_in, ostream& out)
   condTerminate(wcnf_in.fail(), 1,
                 "Error: Bad input stream (check filepath)\n");
 
-  weight_t top;
-  vector<weight_t> weights;
-  vector<int> file_assumptions;
-  vector<vector<int>> tmp_clauses;
+  WCNFData wcnf;
+  parseWCNF(wcnf_in, wcnf);
+  load(wcnf);
 
-  parseWCNF(wcnf_in, weights, branchVars, top, tmp_clauses,
-            file_assumptions, max_var);
+  parse_timer.stop();
+}
+
+ProblemInstance::ProblemInstance(WCNFData& wcnf, ostream& out)
+    : cfg(GlobalConfig::get()),
+      LB(0),
+      UB(numeric_limits<weight_t>::max()),
+      sat_solver(nullptr),
+      mip_solver(nullptr),
+      muser(nullptr),
+      rotation(clauses, bvars),
+      max_var(0),
+      fixed_variables(0),
+      varmap(nullptr),
+      cost_eval(bvar_clauses, bvars),
+      offered_UB(numeric_limits<weight_t>::max()),
+      preprocessor(nullptr),
+      out(out)
+{
+  parse_timer.start();
+  load(wcnf);
+  parse_timer.stop();
+}
+
+// preprocess parsed clauses (if enabled) and build the instance
+void ProblemInstance::load(WCNFData& wcnf) {
+
+  weight_t top = wcnf.top;
+  vector<weight_t>& weights = wcnf.weights;
 
   // validate cnf weights
   weight_t weight_sum = 0;
   for (weight_t w : weights) {
-    if (w != top) {
-      if (numeric_limits<int64_t>::max() - w <= weight_sum) {
-        terminate(1, "Error: Sum of soft weights exceeds max weight\n");
-      } else {
-        weight_sum += w;
-      }
+    if (w != top && !addWeight(weight_sum, w)) {
+      terminate(1, "Error: Sum of soft weights exceeds max weight\n");
     }
   }
 
@@ -110,38 +149,86 @@ ProblemInstance::ProblemInstance(istream& wcnf_in, ostream& out)
   if (cfg.preprocess) {
     preprocess_timer.start();
 
+    vector<vector<int>> tmp_clauses;
     vector<vector<int>> preprocessed_clauses;
     vector<weight_t> preprocessed_weights;
-    file_assumptions.clear();
+    wcnf.assumptions.clear();
 
     int loglevel = 0;
     double time_limit = 1e9;
 
+    unsigned n_clauses = wcnf.nClauses();
+    tmp_clauses.reserve(n_clauses);
+    for (unsigned i = 0; i < n_clauses; ++i)
+      tmp_clauses.emplace_back(wcnf.clauseBegin(i), wcnf.clauseEnd(i));
+    vector<int>().swap(wcnf.lits);
+
     preprocessor = new maxPreprocessor::PreprocessorInterface(tmp_clauses, weights, top);
 
     preprocessor->preprocess(cfg.pre_techniques, loglevel, time_limit);
 
-    preprocessor->getInstance(preprocessed_clauses, preprocessed_weights, file_assumptions);
+    preprocessor->getInstance(preprocessed_clauses, preprocessed_weights, wcnf.assumptions);
+    vector<vector<int>>().swap(tmp_clauses);
 
-    weights = preprocessed_weights;
-    tmp_clauses = preprocessed_clauses;
+    // back to flat form
+    weights.swap(preprocessed_weights);
+    wcnf.offsets.assign(1, 0);
+    for (auto & cl : preprocessed_clauses) {
+      wcnf.lits.insert(wcnf.lits.end(), cl.begin(), cl.end());
+      wcnf.offsets.push_back(wcnf.lits.size());
+    }
+    vector<vector<int>>().swap(preprocessed_clauses);
 
     preprocess_timer.stop();
 
     log(1, "c preprocessing time %lu ms\n", preprocess_timer.cpu_ms_total());
 
     if (cfg.pre_only) {
-      printf("p wcnf %d %lu %lu\n", 0, tmp_clauses.size(), top);
-      for (unsigned i = 0; i < tmp_clauses.size(); ++i) {
+      printf("p wcnf %d %u %lu\n", 0, wcnf.nClauses(), top);
+      for (unsigned i = 0; i < wcnf.nClauses(); ++i) {
         printf("%ld", weights[i]);
-        for (int l : tmp_clauses[i])
-          printf(" %d", l);
+        for (int * l = wcnf.clauseBegin(i); l != wcnf.clauseEnd(i); ++l)
+          printf(" %d", *l);
         printf(" 0\n");
       }
       exit(1);
     }
   }
 
+  if (cfg.instanceCache.size() && filename.size()) {
+    condLog(!writeInstanceCache(cfg.instanceCache.c_str(), filename.c_str(), wcnf, varmap, preprocessor),
+            1, "c could not write instance cache %s\n", cfg.instanceCache.c_str());
+  }
+
+  build(wcnf);
+}
+
+bool ProblemInstance::loadCache(const string & cache_path) {
+  WCNFData wcnf;
+  if (!readInstanceCache(cache_path.c_str(), filename.c_str(), wcnf, varmap, preprocessor))
+    return false;
+  log(1, "c loaded instance cache %s\n", cache_path.c_str());
+  build(wcnf);
+  return true;
+}
+
+// build the instance from parsed or preprocessed clauses
+void ProblemInstance::build(WCNFData& wcnf) {
+
+  weight_t top = wcnf.top;
+  vector<weight_t>& weights = wcnf.weights;
+  vector<int>& file_assumptions = wcnf.assumptions;
+
+  max_var = wcnf.n_vars;
+  branchVars = wcnf.branchVars;
+
+  vector<int> clause;
+  auto getClause = [&](unsigned i) -> vector<int>& {
+    clause.assign(wcnf.clauseBegin(i), wcnf.clauseEnd(i));
+    return clause;
+  };
+  unsigned n_clauses = wcnf.nClauses();
+
   //for (int i = 1; i <= max_var; ++i)
   //  isOriginalVariable[i] = true;
 
@@ -152,38 +239,40 @@ ProblemInstance::ProblemInstance(istream& wcnf_in, ostream& out)
     for (unsigned i = 0; i < file_assumptions.size(); ++i) {
       int a = file_assumptions[i];
       if (a > 0) {
-        flippedInternalVarPolarity[abs(a)] = true;
+        flippedInternalVarPolarity.set(abs(a));
       }
     }
 
-    for (unsigned i = 0; i < tmp_clauses.size(); ++i) {
+    for (unsigned i = 0; i < n_clauses; ++i) {
       if (weights[i] < top) {
-        if (tmp_clauses[i].size() == 1 &&
+        vector<int>& cl = getClause(i);
+        if (cl.size() == 1 &&
             count(file_assumptions.begin(), file_assumptions.end(),
-                  tmp_clauses[i][0])) {
-          int bv = abs(tmp_clauses[i][0]);
+                  cl[0])) {
+          int bv = abs(cl[0]);
           addBvar(bv, weights[i]);
-          isOriginalVariable[bv] = true;
+          isOriginalVariable.set(bv);
         } else {
-          addSoftClause(tmp_clauses[i], weights[i]);
+          addSoftClause(cl, weights[i]);
         }
       }
     }
     //
     // LCNF: add hard clauses
     //
-    for (unsigned i = 0; i < tmp_clauses.size(); ++i) {
+    for (unsigned i = 0; i < n_clauses; ++i) {
       if (weights[i] >= top) {
+        vector<int>& cl = getClause(i);
         // check if a bvar exists in the hard clause
-        for (int v : tmp_clauses[i]) {
-          if (bvar_weights.count(abs(v)) == 1) {
+        for (int v : cl) {
+          if (bvars.contains(abs(v))) {
             // add as soft clause using existing variables
-            addSoftClauseWithBv(tmp_clauses[i]);
+            addSoftClauseWithBv(cl);
             goto next_clause;
           }
         }
         // else add normally as hard clause
-        addHardClause(tmp_clauses[i]);
+        addHardClause(cl);
       next_clause:
         continue;
       }
@@ -192,85 +281,68 @@ ProblemInstance::ProblemInstance(istream& wcnf_in, ostream& out)
     //
     // Normal WCNF instance
     //
-    for (unsigned i = 0; i < tmp_clauses.size(); ++i) {
+    for (unsigned i = 0; i < n_clauses; ++i) {
       if (weights[i] < top) {
-        addSoftClause(tmp_clauses[i], weights[i]);
+        addSoftClause(getClause(i), weights[i]);
       } else {
-        addHardClause(tmp_clauses[i]);
+        addHardClause(getClause(i));
       }
     }
   }
 
-  parse_timer.stop();
+  // the parsed clauses are no longer needed
+  vector<int>().swap(wcnf.lits);
+  vector<size_t>().swap(wcnf.offsets);
+  vector<weight_t>().swap(wcnf.weights);
 }
 
 ProblemInstance::~ProblemInstance() {
-  for (auto p : clauses) delete p;
-  for (auto e : bvar_soft_clauses)
-    for (auto p : e.second) delete p;
-
   delete sat_solver;
   delete mip_solver;
   if (muser) delete muser;
+  delete preprocessor;
 }
 
 void ProblemInstance::attach(MinisatSolver* s) {
   sat_solver = s;
-
-  // add all variables to solver
-  for (int i = 0; i <= max_var; ++i) sat_solver->addVariable(i);
-
-  // create assumption data for bvars
-  for (auto kv : bvar_weights) sat_solver->addBvarAssumption(kv.first);
-
-  // if user-specified branching for sat solver, set decision vars
-  if (branchVars.size() > 0) {
-    for (int i = 0; i < sat_solver->nVars(); ++i)
-      sat_solver->setVarDecision(i, false);
-    for (int v : branchVars) sat_solver->setVarDecision(v, true);
-  }
-
-  for (auto cl : clauses) {
-    if (!sat_solver->addConstraint(*cl)) {
-      isUNSAT = true;
-      return;
-    }
-  }
+  if (!loadClauses(sat_solver)) isUNSAT = true;
 }
 
 void ProblemInstance::attachMuser(MinisatSolver* s) {
   muser = s;
+  if (!loadClauses(muser)) isUNSAT = true;
+}
 
+bool ProblemInstance::loadClauses(MinisatSolver* s) {
   // add all variables to solver
-  for (int i = 0; i <= max_var; ++i) muser->addVariable(i);
+  for (int i = 0; i <= max_var; ++i) s->addVariable(i);
 
   // create assumption data for bvars
-  for (auto kv : bvar_weights) muser->addBvarAssumption(kv.first);
+  for (unsigned i = 0; i < bvars.size(); ++i) s->addBvarAssumption(bvars.var(i));
 
   // if user-specified branching for sat solver, set decision vars
   if (branchVars.size() > 0) {
-    for (int i = 0; i < muser->nVars(); ++i)
-      muser->setVarDecision(i, false);
-    for (int v : branchVars) muser->setVarDecision(v, true);
+    for (int i = 0; i < s->nVars(); ++i)
+      s->setVarDecision(i, false);
+    for (int v : branchVars) s->setVarDecision(v, true);
   }
 
-  for (auto cl : clauses) {
-    if (!muser->addConstraint(*cl)) {
-      isUNSAT = true;
-      return;
-    }
-  }
+  for (unsigned i = 0; i < clauses.size(); ++i)
+    if (!s->addConstraint(clauses.begin(i), clauses.end(i)))
+      return false;
+
+  return true;
 }
 
-void ProblemInstance::attach(CPLEXSolver* s) {
+void ProblemInstance::attach(HSSolver* s) {
   mip_solver = s;
-  mip_solver->addObjectiveVariables(bvar_weights);
+  mip_solver->addObjectiveVariables(bvars);
 }
 
 void ProblemInstance::toLCNF(ostream& out) {
   // declare labels
   /*out << "c assumptions";
-  for (auto v_w : bvar_weights) {
+  for (auto v_w : bvars) {
     int var = v_w.first;
     out << " " << (flippedInternalVarPolarity[var] ? -var : var);
   }
@@ -278,19 +350,19 @@ void ProblemInstance::toLCNF(ostream& out) {
 
   // header
   long top = numeric_limits<long>::max() / 2;
-  out << "p wcnf " << max_var << " " << (clauses.size() + bvar_weights.size()) << " " << top << endl;
+  out << "p wcnf " << max_var << " " << (clauses.size() + bvars.size()) << " " << top << endl;
 
   // hard clauses
-  for (auto clause : clauses) {
+  for (unsigned i = 0; i < clauses.size(); ++i) {
     out << top;
-    for (auto lit : *clause) {
-      out << " " << (flippedInternalVarPolarity[abs(lit)] ? -lit : lit);
+    for (const int * l = clauses.begin(i); l != clauses.end(i); ++l) {
+      out << " " << (flippedInternalVarPolarity[abs(*l)] ? -*l : *l);
     }
     out << " 0" << endl;
   }
 
   // label-clauses
-  for (auto v_w : bvar_weights) {
+  for (auto v_w : bvars) {
     auto weight = v_w.second;
     auto var = v_w.first;
     out << weight << " " << (flippedInternalVarPolarity[var] ? var : -var) << " 0" << endl;
@@ -324,12 +396,10 @@ void ProblemInstance::forbidCurrentModel() {
 // add a hard clause to the SAT instance
 void ProblemInstance::addHardClause(vector<int>& hc, bool original) {
 
-  UB_solution.clear();
-  UB_bool_solution.clear();
-  UB = numeric_limits<weight_t>::max();
+  resetUB();
 
   for (int l : hc) {
-    assert(bvar_weights.count(abs(l)) == 0);
+    assert(!bvars.contains(abs(l)));
 
     max_var = max(abs(l), max_var);
     if (sat_solver != nullptr && max_var >= sat_solver->nVars())
@@ -339,13 +409,10 @@ void ProblemInstance::addHardClause(vector<int>& hc, bool original) {
       muser->addVariable(max_var);
   }
 
-  auto clause = new vector<int>(hc);
-
   if (original)
-    for (int l : hc) isOriginalVariable[abs(l)] = true;
+    for (int l : hc) isOriginalVariable.set(abs(l));
 
-  hard_clauses.push_back(clause);
-  clauses.push_back(clause);
+  hard_clauses.push_back(clauses.add(hc));
 
   if (sat_solver != nullptr) {
     if (!sat_solver->addConstraint(hc)) {
@@ -364,9 +431,7 @@ void ProblemInstance::addHardClause(vector<int>& hc, bool original) {
 int ProblemInstance::addSoftClause(vector<int>& sc, weight_t weight,
                                    bool original)
 {
-  UB_solution.clear();
-  UB_bool_solution.clear();
-  UB = numeric_limits<weight_t>::max();
+  resetUB();
 
   if (weight < EPS) {
     printf("c warning: ignoring 0-weight clause\n");
@@ -374,7 +439,7 @@ int ProblemInstance::addSoftClause(vector<int>& sc, weight_t weight,
   }
 
   for (int l : sc) {
-    assert(bvar_weights.count(abs(l)) == 0);
+    assert(!bvars.contains(abs(l)));
 
     max_var = max(abs(l), max_var);
     if (sat_solver != nullptr)
@@ -384,30 +449,26 @@ int ProblemInstance::addSoftClause(vector<int>& sc, weight_t weight,
       while (max_var >= muser->nVars()) muser->addVariable(max_var);
   }
 
-  auto clause = new vector<int>(sc);
-
   if (original)
-    for (int l : *clause) isOriginalVariable[abs(l)] = true;
+    for (int l : sc) isOriginalVariable.set(abs(l));
 
   int bVar = ++max_var;
   addBvar(bVar, weight);
-  updateBvarMap(bVar, clause);
+  updateBvarMap(bVar, bvar_clauses.add(sc));
 
-  auto b_clause = new vector<int>(sc);
+  unsigned id = clauses.add(sc);
+  clauses.extend(bVar);
+  soft_clauses.push_back(id);
 
-  (*b_clause).push_back(bVar);
-  clauses.push_back(b_clause);
-  soft_clauses.push_back(b_clause);
-
-  if (sat_solver != nullptr) sat_solver->addConstraint(*b_clause);
-  if (muser != nullptr) muser->addConstraint(*b_clause);
+  if (sat_solver != nullptr) sat_solver->addConstraint(clauses.begin(id), clauses.end(id));
+  if (muser != nullptr) muser->addConstraint(clauses.begin(id), clauses.end(id));
 
   return bVar;
 }
 
 void ProblemInstance::addBvar(int bVar, weight_t weight) {
   assert(bVar > 0);
-  assert(bvar_weights.count(bVar) == 0);
+  assert(!bvars.contains(bVar));
 
   if (sat_solver != nullptr) {
     sat_solver->addVariable(bVar);
@@ -420,15 +481,14 @@ void ProblemInstance::addBvar(int bVar, weight_t weight) {
   if (mip_solver != nullptr) {
     mip_solver->addObjectiveVariable(bVar, weight);
   }
-  bvar_weights[bVar] = weight;
+  bvars.add(bVar, weight);
+  cost_eval.invalidate();
 }
 
 // add a soft clause to the SAT instance with existing bvar(s)
 void ProblemInstance::addSoftClauseWithBv(vector<int>& sc_, bool original)
 {
-  UB_solution.clear();
-  UB_bool_solution.clear();
-  UB = numeric_limits<weight_t>::max();
+  resetUB();
 
   for (unsigned i = 0; i < sc_.size(); i++) {
     int v = abs(sc_[i]);
@@ -437,52 +497,46 @@ void ProblemInstance::addSoftClauseWithBv(vector<int>& sc_, bool original)
       sc_[i] *= -1;
   }
 
-  auto sc = new vector<int>(sc_);
-
   if (original)
-    for (int l : *sc) isOriginalVariable[abs(l)] = true;
+    for (int l : sc_) isOriginalVariable.set(abs(l));
 
-  for (int v : *sc) {
-    if (bvar_weights.count(abs(v)) == 1) {  // v is a bvar
-      auto cl = new vector<int>(sc->size() - 1);
-      copy_if(sc->begin(), sc->end(), cl->begin(),
+  vector<int> cl;
+  for (int v : sc_) {
+    if (bvars.contains(abs(v))) {  // v is a bvar
+      cl.clear();
+      copy_if(sc_.begin(), sc_.end(), back_inserter(cl),
               [&](int l) { return abs(l) != abs(v); });
-      updateBvarMap(abs(v), cl);
+      updateBvarMap(abs(v), bvar_clauses.add(cl));
     }
   }
 
-  clauses.push_back(sc);
-  soft_clauses.push_back(sc);
+  unsigned id = clauses.add(sc_);
+  soft_clauses.push_back(id);
 
-  if (sat_solver != nullptr) sat_solver->addConstraint(*sc);
-  if (muser != nullptr) muser->addConstraint(*sc);
+  if (sat_solver != nullptr) sat_solver->addConstraint(sc_);
+  if (muser != nullptr) muser->addConstraint(sc_);
 }
 
-void ProblemInstance::updateBvarMap(int bVar, vector<int>* sc) {
+void ProblemInstance::updateBvarMap(int bVar, unsigned clause_id) {
   assert(bVar > 0);
-  assert(bvar_weights.count(bVar));
+  assert(bvars.contains(bVar));
 
-  bvar_clause_ct[bVar]++;
-  if (bvar_soft_clauses.count(bVar)) {
-    bvar_soft_clauses[bVar].push_back(sc);
-  } else {
-    bvar_soft_clauses[bVar] = {sc};
-  }
+  bvars.addClause(bvars.index(bVar), clause_id);
+  cost_eval.invalidate();
 }
 
 void ProblemInstance::forceBvar(int bv, bool pol) {
   // fix the variable in sat solver
   fixed_variables++;
 
-  vector<int> * unit_cl = new vector<int>({ pol ? bv : -bv });
+  vector<int> unit_cl({ pol ? bv : -bv });
 
-  hard_clauses.push_back(unit_cl);
-  clauses.push_back(unit_cl);
+  hard_clauses.push_back(clauses.add(unit_cl));
 
   if (sat_solver != nullptr) {
     if (pol == false)
       sat_solver->removeBvarAssumption(bv);
-    if (!sat_solver->addConstraint(*unit_cl)) {
+    if (!sat_solver->addConstraint(unit_cl)) {
       isUNSAT = true;
     }
   }
@@ -490,16 +544,15 @@ void ProblemInstance::forceBvar(int bv, bool pol) {
   if (muser != nullptr) {
     if (pol == false)
       muser->removeBvarAssumption(bv);
-    if (!muser->addConstraint(*unit_cl)) {
+    if (!muser->addConstraint(unit_cl)) {
       isUNSAT = true;
     }
   }
 
   // remove from structures
   if (pol == false) {
-    bvar_weights.erase(bv);
-    bvar_soft_clauses.erase(bv);
-    bvar_clause_ct.erase(bv);
+    bvars.remove(bv);
+    cost_eval.invalidate();
   }
 
   // TODO: remove from found cores
@@ -515,9 +568,9 @@ void ProblemInstance::printStats() {
   log(1, "c Core reduce time: %lu ms\n", reduce_timer.cpu_ms_total());
 
   log(1, "c Variables:        %d\n", sat_solver->nVars());
-  log(1, "c Labels:           %lu\n", bvar_weights.size());
+  log(1, "c Labels:           %u\n", bvars.size());
   log(1, "c Fixed:            %u\n", fixed_variables);
-  log(1, "c Clauses:          %lu\n", clauses.size());
+  log(1, "c Clauses:          %u\n", clauses.size());
   log(1, "c Hard clauses:     %lu\n", hard_clauses.size());
   log(1, "c Soft clauses:     %lu\n", soft_clauses.size());
 }
@@ -531,34 +584,22 @@ void ProblemInstance::getSolution(vector<int>& out_solution, MinisatSolver * sol
   condTerminate(solver == nullptr, 1,
                 "Error: no SAT solver attached to ProblemInstance\n");
 
-  out_solution.clear();
   vector<bool> model;
   solver->getModel(model);
+  getSolution(out_solution, model);
+}
 
-  assert(model.size() > 0 || max_var == 0); // Error: no model given by SAT solver
+void ProblemInstance::getSolution(vector<int>& out_solution, vector<bool> model) {
+  out_solution.clear();
 
-  for (auto b_w : bvar_weights) {
-    int b = b_w.first;
-    // if bVar is selected, we check that it is necessary
-    if (model[abs(b)]) {
-      // for each clause of the bvar
-      for (auto cl : bvar_soft_clauses[b]) {
-        // check if it is satisfied
-        for (int lit : *cl) {
-          if ((lit > 0) == model[abs(lit)])
-            goto cl_sat;
-        }
-        // if unsat, we stop and count the cost of the bvar
-        goto next_bv;
+  assert(model.size() > 0 || max_var == 0); // Error: no model given by SAT solver
 
-        // if sat, we check the remaining clauses
-        cl_sat: continue;
-      }
-      // all clauses satisfied, so we change the model
-      // to disable the bvar and recompute
-      model[abs(b)] = false;
-    }
-    next_bv: continue;
+  for (unsigned i = 0; i < bvars.size(); ++i) {
+    int b = bvars.var(i);
+    // if bVar is selected but all its clauses are satisfied,
+    // we change the model to disable the bvar
+    if (model[b] && bVarSatisfied(model, i))
+      model[b] = false;
   }
 
   for (unsigned i = 0; i < model.size(); ++i) {
@@ -568,12 +609,12 @@ void ProblemInstance::getSolution(vector<int>& out_solution, MinisatSolver * sol
   }
 }
 
-bool ProblemInstance::bVarSatisfied(vector<bool> & model, int b) {
+bool ProblemInstance::bVarSatisfied(vector<bool> & model, unsigned i) {
   // for each clause of the bvar
-  for (auto cl : bvar_soft_clauses[b]) {
+  for (unsigned id : bvars.clauses(i)) {
     // check if it is satisfied
-    for (int lit : *cl) {
-      if ((lit > 0) == model[abs(lit)])
+    for (const int * l = bvar_clauses.begin(id); l != bvar_clauses.end(id); ++l) {
+      if ((*l > 0) == model[abs(*l)])
         goto cl_sat;
     }
 
@@ -589,12 +630,12 @@ bool ProblemInstance::bVarSatisfied(vector<bool> & model, int b) {
 weight_t ProblemInstance::tightenModel(vector<bool>& model) {
   weight_t model_cost = 0;
 
-  for (auto b_w : bvar_weights) {
-    int b = b_w.first;
-    weight_t w = b_w.second;
+  for (unsigned i = 0; i < bvars.size(); ++i) {
+    int b = bvars.var(i);
+    weight_t w = bvars.weight(i);
     // if bVar is selected, we check if it is necessary
     if (model[b]) {
-      if (bVarSatisfied(model, b)) {
+      if (bVarSatisfied(model, i)) {
         // clauses of the bvar are satisfied, it is redundant
         model[b] = false;
       } else {
@@ -617,7 +658,9 @@ weight_t ProblemInstance::getSolutionWeight(MinisatSolver * solver) {
   vector<bool> model;
   solver->getModel(model);
 
-  weight_t w = tightenModel(model);
+  weight_t w;
+  if (!cost_eval.evaluate(model, w))
+    w = tightenModel(model);
 
   return w;
 
@@ -625,7 +668,7 @@ weight_t ProblemInstance::getSolutionWeight(MinisatSolver * solver) {
 
 weight_t ProblemInstance::totalWeight() {
   weight_t sum = 0;
-  for (auto v_w : bvar_weights) sum += v_w.second;
+  for (unsigned i = 0; i < bvars.size(); ++i) sum += bvars.weight(i);
   return sum;
 }
 
@@ -635,16 +678,17 @@ void ProblemInstance::getBvarEquivConstraints(
 {
   unordered_map<int, int> eqs;
 
-  for (auto& p : bvar_soft_clauses) {
-    int bvar = p.first;
+  for (unsigned i = 0; i < bvars.size(); ++i) {
+    int bvar = bvars.var(i);
     eqs[bvar] = bvar;
     // no equivalence if same bvar has multiple clauses
-    if (p.second.size() == 1) {
-      vector<int>& sc = *(p.second[0]);
-      if (sc.size() == 1 && bvar_weights.count(abs(sc[0])) == 0) {
+    if (bvars.clauses(i).size() == 1) {
+      unsigned id = bvars.clauses(i)[0];
+      if (bvar_clauses.clauseSize(id) == 1 &&
+          !bvars.contains(abs(*bvar_clauses.begin(id)))) {
         // For finding an optimal solution, the b-variable of a unit clause
         // is equivalent to the negation of that clause's literal
-        int l = sc[0];
+        int l = *bvar_clauses.begin(id);
         int v = abs(l);
 
         int s = l < 0 ? 1 : -1;
@@ -653,10 +697,11 @@ void ProblemInstance::getBvarEquivConstraints(
     }
   }
 
-  for (auto cl : clauses) {
+  for (unsigned i = 0; i < clauses.size(); ++i) {
     vector<int> constr;
 
-    for (int l : *cl) {
+    for (const int * p = clauses.begin(i); p != clauses.end(i); ++p) {
+      int l = *p;
       if (eqs.count(abs(l)) == 0) goto bv_eq_next_clause;
       int s = l < 0 ? -1 : 1;
       if (!count(constr.begin(), constr.end(), (eqs[abs(l)] * s)))
@@ -676,249 +721,108 @@ void ProblemInstance::getLabelOnlyClauses(vector<vector<int>>& label_cls)
 
   label_cls.clear();
 
-  function<bool(vector<int>*)> isLabelClause = [this](vector<int>* v) {
-    return all_of(v->begin(), v->end(),
-                  [this](int i) { return bvar_weights.count(abs(i)) == 1; });
+  function<bool(unsigned)> isLabelClause = [this](unsigned id) {
+    return all_of(clauses.begin(id), clauses.end(id),
+                  [this](int i) { return bvars.contains(abs(i)); });
   };
 
-  for (auto sc : soft_clauses)
-    if (isLabelClause(sc)) label_cls.push_back(*sc);
+  for (unsigned id : soft_clauses)
+    if (isLabelClause(id)) label_cls.push_back(clauses.get(id));
 }
 
 void ProblemInstance::reduceCore(vector<int>& core, MinimizeAlgorithm alg) {
+  reduce_timer.start();
+  if (cfg.modelRotation) rotation.sync();
+  reduceCore(core, alg, cfg.separate_muser ? muser : sat_solver);
+  reduce_timer.stop();
+}
+
+void ProblemInstance::reduceCore(vector<int>& core, MinimizeAlgorithm alg,
+                                 MinisatSolver * min_solver) {
   log(3, "c ProblemInstance::reduceCore (size %lu)\n", core.size());
   logCore(3, core);
-  MinisatSolver * min_solver = cfg.separate_muser ? muser : sat_solver;
 
   if (core.size() == 1) return;
 
-  reduce_timer.start();
-
   switch (alg) {
     case MinimizeAlgorithm::binary:
-      binarySearchMinimize(min_solver, core);
+      CoreMinimizer(*this, min_solver, core).binarySearch();
       break;
     case MinimizeAlgorithm::rerefute:
       reRefuteCore(min_solver, core);
       break;
     case MinimizeAlgorithm::constructive:
-      constructiveMinimize(min_solver, core);
+      CoreMinimizer(*this, min_solver, core).constructive();
       break;
     case MinimizeAlgorithm::destructive:
-      destructiveMinimize(min_solver, core);
+      CoreMinimizer(*this, min_solver, core).destructive();
       break;
     case MinimizeAlgorithm::cardinality:
       cardinalityMinimize(min_solver, core);
       break;
+    case MinimizeAlgorithm::quickxplain:
+      CoreMinimizer(*this, min_solver, core).quickXplain();
+      break;
+    case MinimizeAlgorithm::progression:
+      CoreMinimizer(*this, min_solver, core).progression();
+      break;
   }
-
-  reduce_timer.stop();
 }
 
-
-//
-void ProblemInstance::constructiveMinimize(MinisatSolver * solver, vector<int>& core) {
-  log(3, "c ProblemInstance::constructiveMinimize (size %lu)\n", core.size());
-  vector<int> mus;
-  vector<int> lits(core);
-  random_shuffle(lits.begin(), lits.end());
-  vector<int> subcore;
-
-  bool is_mus = false;
-
-  while( !is_mus ) {
-
-    solver->setBvars();
-    for (int b : mus)
-      solver->unsetBvar(b);
-
-    for (unsigned i = 0; i <= lits.size(); ++i) {
-      solver->clearAssumptions();
-      solver->assumeBvars();
-      solver->findCore(subcore);
-      bool sat = !subcore.size();
-
-      if (sat) {
-        weight_t w = getSolutionWeight(solver);
-        if (w < UB) {
-          printf("c UB improved in minimize %lu -> %lu\n", UB, w);
-          updateUB(w, solver);
-        }
-        // need to add more lits
-        solver->unsetBvar(lits[i]);
-        continue;
-      } else { // unsat
-        if (i == 0) { // mus vector is unsat
-          is_mus = true;
-          break;
-        } else { // lits[i - 1] is critical
-          mus.push_back(lits[i - 1]);
-          lits.clear();
-
-          for (int l : subcore)
-            if (find(mus.begin(), mus.end(), l) == mus.end())
-              lits.push_back(l);
-
-          if (lits.size() == 0) is_mus = true;
-          break;
-        }
-      }
-    }
+// a model of solver found while minimizing a core
+void ProblemInstance::minimizerModel(MinisatSolver * solver) {
+  // other solvers may run in other threads
+  if (solver != sat_solver && solver != muser) {
+    offerModel(solver);
+    return;
   }
 
-  core.swap(mus);
-
-}
-
-void ProblemInstance::binarySearchMinimize(MinisatSolver * solver, vector<int>& core) {
-  log(3, "c ProblemInstance::binarySearchMinimize (size %lu)\n", core.size());
-  vector<int> mus;
-  vector<int> lits(core);
-  random_shuffle(lits.begin(), lits.end());
-  vector<int> subcore;
-
-  //int s = core.size();
-
-  while( true ) {
-    solver->setBvars();
-    for (int b : mus)
-      solver->unsetBvar(b);
-
-    int start = 0;
-    int end = lits.size() - 1;
-    int mid = 0;
-
-    // use binary search to find critical literal
-    while ( start != end ) {
-      mid = (start + end) / 2;
-      solver->setBvars();
-      for (int l : mus)
-        solver->unsetBvar(l);
-      for (int i = 0; i <= mid; ++i)
-        solver->unsetBvar(lits[i]);
-
-      solver->clearAssumptions();
-      solver->assumeBvars();
-      solver->findCore(subcore);
-      bool sat = !subcore.size();
-
-      if (sat) {
-        weight_t w = getSolutionWeight(solver);
-        if (w < UB) {
-          printf("c UB improved in minimize %lu -> %lu\n", UB, w);
-          updateUB(w, solver);
-        }
-        start = mid + 1;
-      } else {
-        end = mid;
-      }
-    }
-    // lits[start] is critical
-    mus.push_back(lits[start]);
-    lits[start] = lits[lits.size() - 1];
-    lits.pop_back();
-
-    // loop until mus unsat
-    solver->setBvars();
-    for (auto l : mus) solver->unsetBvar(l);
-
-    solver->clearAssumptions();
-    solver->assumeBvars();
-    solver->findCore(subcore);
-    if (subcore.size()) break;
+  weight_t w = getSolutionWeight(solver);
+  if (w < UB) {
+    printf("c UB improved in minimize %lu -> %lu\n", UB, w);
+    updateUB(w, solver);
   }
-
-  core.swap(mus);
 }
 
-// Minimize a core using a simple destructive algorithm
-// for each s in core test if core \ {s} is a core, and updating if it is
-void ProblemInstance::destructiveMinimize(MinisatSolver * solver, vector<int>& core) {
-  log(3, "c ProblemInstance::destructiveMinimize (size %lu)\n", core.size());
-  //unsigned origSize = core.size();
-  //++minimizeCalls;
-
-  // set only soft clauses in core active
-  solver->setBvars();
-  for (int b : core)
-    solver->unsetBvar(b);
+// with --model-rotation, the members of core the model of solver proves
+// critical: c, or else the only member the model falsifies, and the
+// members found by rotating from it
+void ProblemInstance::rotateModel(MinisatSolver * solver, const vector<int>& core,
+                                  vector<int>& critical, int c) {
+  if (!cfg.modelRotation) return;
 
-  vector<int> subcore;
+  vector<bool> model;
+  solver->getModel(model);
+  if (!c) c = rotation.falsified(model, core);
+  if (!c) return;
 
-  // sort core in order of descending weight
-  sort(core.begin(), core.end(), [&](int b1, int b2){
-    if (bvar_weights[b1] == bvar_weights[b2])
-      return b1 > b2;
-    return bvar_weights[b1] > bvar_weights[b2];
-  });
+  if (find(critical.begin(), critical.end(), c) == critical.end())
+    critical.push_back(c);
+  rotation.rotate(model, c, core, critical, cfg.recursiveRotation);
+}
 
-  // for each clause core[i] in the core, check if core \ {core[i]}
-  // is unsatisfiable. If so, remove core[i] from the core
+void ProblemInstance::sortByWeight(vector<int>& core) {
+  // look up each weight once instead of in the comparator
+  vector<pair<weight_t, int>> keyed;
+  keyed.reserve(core.size());
+  for (int b : core) keyed.emplace_back(bvars.weightOf(b), b);
+  sort(keyed.begin(), keyed.end(), greater<pair<weight_t, int>>());
+  for (unsigned i = 0; i < core.size(); ++i) core[i] = keyed[i].second;
+}
 
+bool ProblemInstance::setMinimizeBudget(MinisatSolver * solver) {
   long propBudget = cfg.minimizePropLimit;
   long confBudget = cfg.minimizeConfLimit;
-  bool limited = propBudget || confBudget;
-
-  if (limited) solver->setBudgets(propBudget, confBudget);
-
-  int calls = 0;
-
-  for (unsigned i = 0; i < core.size(); i++) {
-
-    if (++calls > cfg.minimizeLimit) break;
-
 
-    int testClause = core[i];
-    solver->setBvar(testClause);
-
-    /*
-    printf("c trying");
-    for (unsigned j = 0; j < core.size(); ++j)
-      if (i != j)
-        printf(" %d", core[j]);
-    printf("\n");
-    */
-
-    if (limited) {
-      solver->clearAssumptions();
-      solver->assumeBvars();
-      // stop minimization on exceeding resource budgets
-      if (!solver->findCoreLimited(subcore)) break;
-    } else {
-      solver->clearAssumptions();
-      solver->assumeBvars();
-      solver->findCore(subcore);
-    }
-
-    if (subcore.size() > 0) {
-
-      core.swap(subcore);
-
-      // sort subcore in order of descending weight
-      sort(core.begin(), core.end(), [&](int b1, int b2){
-        if (bvar_weights[b1] == bvar_weights[b2])
-          return b1 > b2;
-        return bvar_weights[b1] > bvar_weights[b2];
-      });
-
-      // core[i] and possibly some of core[i..n] removed
-      // core[0..i-1] known to be critical
-      --i;
-    } else {
-      weight_t w = getSolutionWeight(solver);
-      if (w < UB) {
-        printf("c UB improved in minimize %lu -> %lu\n", UB, w);
-        updateUB(w, solver);
-      }
-      solver->unsetBvar(testClause);
-    }
+  // anytime minimization, scaled to the recent calls of solver
+  if (cfg.minimizeBudgetFactor > 0) {
+    long adaptive = max(1000L, long(cfg.minimizeBudgetFactor * solver->recentConflicts()));
+    confBudget = confBudget ? min(confBudget, adaptive) : adaptive;
   }
 
-  assert(core.size());
-
-  //int litsRemoved = origSize - core.size();
-  //if (litsRemoved) ++coresMinimized;
-  //minimizedLits += litsRemoved;
+  bool limited = propBudget || confBudget;
+  if (limited) solver->setBudgets(propBudget, confBudget);
+  return limited;
 }
 
 void ProblemInstance::cardinalityMinimize(MinisatSolver * solver, vector<int>& core) {
@@ -927,12 +831,14 @@ void ProblemInstance::cardinalityMinimize(MinisatSolver * solver, vector<int>& c
   vector<int> subcore;
   vector<int> mus;
   vector<int> lits(core);
+  vector<int> rotated;
+  bool limited = setMinimizeBudget(solver);
 
   // add |relaxed lits| <= 1 constraint
 
   vector<int> enc_vars = solver->addTempAtMostOneEncoding(lits);
   int card_id = enc_vars[0];
-  for (int v : enc_vars) isOriginalVariable[v] = false;
+  for (int v : enc_vars) isOriginalVariable.set(v, false);
 
   while (true) {
     // remove all assumptions
@@ -940,8 +846,8 @@ void ProblemInstance::cardinalityMinimize(MinisatSolver * solver, vector<int>& c
     // activate cardinality constraint
     solver->assumeLit(-card_id);
     // block all soft clauses not in lits
-    for (auto b_w : bvar_weights) {
-      int b = b_w.first;
+    for (unsigned i = 0; i < bvars.size(); ++i) {
+      int b = bvars.var(i);
       if (find(lits.begin(), lits.end(), b) == lits.end() and
           find(mus.begin(), mus.end(), b) == mus.end()) {
         solver->assumeLit(b);
@@ -953,7 +859,17 @@ void ProblemInstance::cardinalityMinimize(MinisatSolver * solver, vector<int>& c
       solver->assumeLit(-l);
 
     subcore.clear();
-    solver->findCore(subcore);
+    if (limited) {
+      // stop minimization on exceeding resource budgets,
+      // mus U lits is still a core
+      if (!solver->findCoreLimited(subcore)) {
+        core = mus;
+        core.insert(core.end(), lits.begin(), lits.end());
+        break;
+      }
+    } else {
+      solver->findCore(subcore);
+    }
 
     if (subcore.size()) { // UNSAT
 
@@ -973,7 +889,7 @@ void ProblemInstance::cardinalityMinimize(MinisatSolver * solver, vector<int>& c
         enc_vars = solver->addTempAtMostOneEncoding(lits);
 
         card_id = enc_vars[0];
-        for (int v : enc_vars) isOriginalVariable[v] = false;
+        for (int v : enc_vars) isOriginalVariable.set(v, false);
 
         continue;
       }
@@ -990,21 +906,31 @@ void ProblemInstance::cardinalityMinimize(MinisatSolver * solver, vector<int>& c
       // Find which l \in lits was relaxed to satisfy cardinality constraint
       for (unsigned i = 0; i < lits.size(); ++i) {
         if (model[lits[i]]) {
+          // model rotation may find more transition clauses
+          vector<int> candidates(mus);
+          candidates.insert(candidates.end(), lits.begin(), lits.end());
+          rotated.clear();
+          rotateModel(solver, candidates, rotated, lits[i]);
+
           // this l is a transition clause
           // add it to mus and remove it from lits
           mus.push_back(lits[i]);
           lits[i] = lits[lits.size() - 1];
           lits.pop_back();
+
+          for (int b : rotated) {
+            auto it = find(lits.begin(), lits.end(), b);
+            if (it == lits.end()) continue;
+            mus.push_back(b);
+            *it = lits.back();
+            lits.pop_back();
+          }
           break;
         }
       }
 
       // update ub
-      weight_t w = getSolutionWeight(solver);
-      if (w < UB) {
-        printf("c UB improved in minimize %lu -> %lu\n", UB, w);
-        updateUB(w, solver);
-      }
+      minimizerModel(solver);
     }
   }
 
@@ -1028,8 +954,7 @@ void ProblemInstance::reRefuteCore(MinisatSolver * solver, vector<int>& core) {
     prevSize = core.size();
 
     // set SAT assumptions so only core clauses are active
-    solver->setBvars();
-    for (int b : core) solver->unsetBvar(b);
+    solver->activateOnly(core);
 
     core.clear();
     // Hope for a smaller core
@@ -1059,14 +984,23 @@ void ProblemInstance::updateUB(weight_t w) {
 }
 
 void ProblemInstance::updateUB(weight_t w, MinisatSolver * solver) {
+  assert (w >= LB);
+  if (w < UB) {
+    vector<bool> model;
+    solver->getModel(model);
+    updateUB(w, model);
+  }
+}
+
+void ProblemInstance::updateUB(weight_t w, const vector<bool> & model) {
   assert (w >= LB);
   if (w < UB) {
     UB = w;
 
-    solver->getModel(UB_bool_solution);
+    UB_bool_solution = model;
     tightenModel(UB_bool_solution);
 
-    getSolution(UB_solution, solver); // remember best solution
+    getSolution(UB_solution, UB_bool_solution); // remember best solution
 
     if (cfg.printBounds) {
       out << "c UB " << UB << "\t(" << solve_timer.cpu_ms_total() << " ms)" << endl;
@@ -1078,22 +1012,57 @@ void ProblemInstance::updateUB(weight_t w, MinisatSolver * solver) {
   }
 }
 
+void ProblemInstance::resetUB() {
+  UB_solution.clear();
+  UB_bool_solution.clear();
+  UB = numeric_limits<weight_t>::max();
+
+  lock_guard<mutex> lock(offered_mutex);
+  offered_UB = UB;
+  offered_model.clear();
+}
+
+void ProblemInstance::offerModel(MinisatSolver * solver) {
+  vector<bool> model;
+  solver->getModel(model);
+  weight_t w = tightenModel(model);
+  if (w >= offered_UB) return;
+
+  lock_guard<mutex> lock(offered_mutex);
+  if (w < offered_UB) {
+    offered_UB = w;
+    offered_model.swap(model);
+  }
+}
+
+void ProblemInstance::collectOfferedModel() {
+  lock_guard<mutex> lock(offered_mutex);
+  if (offered_UB < UB) updateUB(offered_UB, offered_model);
+  // later offers have to beat the UB
+  offered_UB = UB;
+}
+
 void ProblemInstance::printSolution(ostream & model_out) {
 
   if (cfg.solveAsMIP || (sat_solver && sat_solver->hasModel) || UB_solution.size()) {
-    model_out << "v ";
+    vector<int> model;
     if (cfg.preprocess) {
       vector<int> UB_copy(UB_solution);
       for (unsigned i = 0; i < UB_copy.size(); ++i)
         if (flippedInternalVarPolarity[abs(UB_copy[i])])
           UB_copy[i] *= -1;
-      model_out << reconstruct(UB_copy);
+      model = reconstruct(UB_copy);
     } else {
       for (int i : UB_solution)
         if (isOriginalVariable[abs(i)])
-          model_out << " " << (flippedInternalVarPolarity[abs(i)] ? -i : i);
+          model.push_back(flippedInternalVarPolarity[abs(i)] ? -i : i);
+    }
+    if (varmap) {
+      // write original variable ids
+      varmap->printModel(model, model_out);
+    } else {
+      model_out << "v " << model << endl;
     }
-    model_out << endl;
     model_out << "o " << UB << endl;
     if (UB == LB)
       model_out << "s OPTIMUM FOUND" << endl;
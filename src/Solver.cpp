@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <set>
 #include <functional>
 #include <thread>
 #include <cstdio>
@@ -15,7 +16,9 @@
 
 #include "Timer.h"
 #include "MinisatSolver.h"
-#include "CPLEXSolver.h"
+#include "HSSolver.h"
+#include "Portfolio.h"
+#include "SolverPool.h"
 
 using namespace std;
 
@@ -23,19 +26,25 @@ Solver::Solver(ProblemInstance &pi, ostream& out)
     : cfg(GlobalConfig::get()),
       instance(pi),
       newInstance(true),
+      current_level(0),
       nSolutions(0),
       nNonoptCores(0),
       nEquivConstraints(0),
       nDisjointCores(0),
+      nPortfolioCores(0),
+      nHardened(0),
+      pool(nullptr),
       out(out)
 {
+  // the greedy hitting sets of an earlier solver have other cores
+  NonoptHS::coresChanged();
 
   if (!cfg.initialized) {
     ofstream nullstream("/dev/null");
     cfg.parseArgs(0, nullptr, nullstream);
   }
 
-  instance.attach(new CPLEXSolver());
+  instance.attach(newHSSolver());
   if (!cfg.solveAsMIP) {
     instance.attach(new MinisatSolver());
     if (cfg.separate_muser) {
@@ -67,7 +76,7 @@ void Solver::solve() {
     bool optFound = false;
 
     weight_t init_UB = 0;
-    for (auto & b_w : instance.bvar_weights) 
+    for (auto b_w : instance.bvars)
       init_UB += b_w.second;
     
     do {
@@ -125,7 +134,7 @@ void Solver::presolve() {
 
   // seed MIP solver with "equiv-constraints"
 
-  if (cfg.doEquivSeed) {
+  if (cfg.doEquivSeed && instance.mip_solver->wantsEquivSeed()) {
 
     vector<vector<int> > equivConstraints;
 
@@ -135,25 +144,86 @@ void Solver::presolve() {
     for (auto & eq : equivConstraints) {
       logCore(2, eq);
       instance.mip_solver->addConstraint(eq);
+      for (int l : eq) in_hs_solver.set(abs(l));
     }
   }
 
   newInstance = false;
 }
 
+// Splits the bvars into weight levels for --stratify. A level is the
+// next distinct weight while the bvars left have few distinct weights
+// for their number, and the weights down to a tenth of the next one
+// otherwise.
+void Solver::stratify() {
+  levels.clear();
+  current_level = 0;
+  if (!cfg.stratify) return;
+
+  vector<pair<weight_t, int>> by_weight;
+  for (auto b_w : instance.bvars) by_weight.push_back(make_pair(b_w.second, b_w.first));
+  sort(by_weight.begin(), by_weight.end(), greater<pair<weight_t, int>>());
+
+  // number of distinct weights in by_weight[i..]
+  unsigned n = by_weight.size();
+  vector<unsigned> distinct(n + 1, 0);
+  for (unsigned i = n; i--;)
+    distinct[i] = distinct[i + 1] + (i + 1 == n || by_weight[i].first != by_weight[i + 1].first);
+
+  for (unsigned i = 0; i < n;) {
+    double diversity = double(distinct[i]) / (n - i);
+    weight_t lowest = by_weight[i].first;
+    if (diversity > cfg.stratDiversity) lowest /= 10;
+
+    levels.emplace_back();
+    for (; i < n && by_weight[i].first >= lowest; ++i) levels.back().push_back(by_weight[i]);
+  }
+  reverse(levels.begin(), levels.end());
+
+  current_level = levels.size() - 1;
+  log(1, "c stratified to %lu levels\n", levels.size());
+}
+
+void Solver::nextLevel() {
+  --current_level;
+  log(1, "c stratification level %d: %lu bvars\n", current_level, levels[current_level].size());
+  harden();
+}
+
+// A bvar in no constraint of the hitting set solver is false in every
+// solution better than UB if its weight exceeds UB - LB: without it, a
+// solution falsifying it would still cost at least LB.
+void Solver::harden() {
+  // the portfolio threads do not see the hardened bvars
+  if (!cfg.stratify || cfg.portfolio > 1 || instance.UB < instance.LB) return;
+  weight_t gap = instance.UB - instance.LB;
+
+  for (int l = levels.size() - 1; l >= 0; --l) {
+    for (auto & w_b : levels[l]) {
+      if (w_b.first <= gap) return;
+      int b = w_b.second;
+      if (in_hs_solver[b] || !instance.bvars.contains(b)) continue;
+      instance.forceBvar(b, false);
+      ++nHardened;
+    }
+  }
+}
+
 void Solver::solveAsMIP() {
   log(3, "c Solver::solveAsMIP\n");
   weight_t weight;
 
   for (int i = 1; i < instance.max_var; ++i)
-    if (!instance.bvar_weights.count(i))
+    if (!instance.bvars.contains(i))
       instance.mip_solver->addVariable(i);
 
-  instance.mip_solver->addObjectiveVariables(instance.bvar_weights);
+  instance.mip_solver->addObjectiveVariables(instance.bvars);
 
   log(1, "c added MIP variables\n");
-  for (auto cl : instance.clauses)
-    instance.mip_solver->addConstraint(*cl);
+  for (unsigned i = 0; i < instance.clauses.size(); ++i) {
+    vector<int> cl = instance.clauses.get(i);
+    instance.mip_solver->addConstraint(cl);
+  }
 
   log(1, "c added MIP constraints\n");
   bool ok = instance.mip_solver->solveForModel(instance.UB_solution, weight);
@@ -179,48 +249,53 @@ void Solver::solveMaxHS() {
   // steps of finding disjoint cores and seeding MIP
   // solver with equiv constraints
 
-  if (newInstance) presolve();
+  if (newInstance) {
+    stratify();
+    presolve();
+  }
+
+  // helper threads sharing cores and solutions with this one
+  Portfolio * portfolio = cfg.portfolio > 1 ? new Portfolio(instance, cfg.portfolio - 1) : nullptr;
+  unsigned pool_size = max(cfg.nonoptThreads, cfg.minimizeThreads);
+  pool = pool_size > 1 ? new SolverPool(instance, pool_size) : nullptr;
 
     // main MaxHS loop
     for (unsigned iteration = 0;;++iteration) {
 
       hs.clear();
 
+      if (portfolio) {
+        portfolio->collectCores(new_cores);
+        for (auto & core : new_cores) processCore(core);
+        nPortfolioCores += new_cores.size();
+
+        instance.collectOfferedModel();
+        if (instance.UB == instance.LB) {
+          log(1, "c solved by LB == UB\n");
+          goto maxhs_stop;
+        }
+      }
+
       // find minimum cost hitting set
       weight_t opt_lb;
-      CPLEXSolver::Status status = instance.mip_solver->solveForHS(hs, opt_lb, &instance);
+      HSSolver::Status status = instance.mip_solver->solveForHS(hs, opt_lb, &instance);
 
       while (!instance.fixQueue.empty()) {
         int fixed = instance.fixQueue.back();
         instance.fixQueue.pop_back();
 
-        coreClauseCounts.erase(fixed);
-
-        for (auto & core : cores) {
-          core.erase(std::remove(core.begin(), core.end(), fixed), core.end());
-          if (core.size() == 0)
-            terminate(1, "Empty core in core set pruning");
-        }
+        core_db.fix(fixed);
+        NonoptHS::coresChanged();
       }
 
       while (!instance.relaxQueue.empty()) {
         int relaxed = instance.relaxQueue.back();
         instance.relaxQueue.pop_back();
-
-        for (auto & core : cores) {
-          if (std::find(core.begin(), core.end(), relaxed) != core.end()) {
-            for (int l : core) {
-              coreClauseCounts[l]--;
-            }
-          } 
-        }
-
-        cores.erase(std::remove_if(cores.begin(), cores.end(), [&](vector<int> & x){
-            return std::find(x.begin(), x.end(), relaxed) != x.end();
-          }), cores.end());
+        core_db.relax(relaxed);
+        NonoptHS::coresChanged();
       }
 
-      if (status == CPLEXSolver::Status::Failed) { // no MIP solution
+      if (status == HSSolver::Status::Failed) { // no MIP solution
         instance.UB_solution.clear();
         log(1, "c empty hitting set\n");
         break;
@@ -228,23 +303,30 @@ void Solver::solveMaxHS() {
         out << "c opt hs " << hs << endl;
       }
 
+      if (portfolio) portfolio->publish(hs);
+
       log(1, "c CPLEX opt %" WGT_FMT "\n", opt_lb);
 
-      if (status == CPLEXSolver::Status::Optimal) {
+      if (status == HSSolver::Status::Optimal) {
         instance.updateLB(opt_lb);
         if (instance.UB == instance.LB) {
           log(1, "c solved by LB == UB\n");
           goto maxhs_stop;
         }
+        harden();
       }
       
       getCores(hs, new_cores);
       
       // satisfiable with current assumptions -> found an optimal solution
       if (new_cores.empty()) {
-        if (status == CPLEXSolver::Status::Optimal) {
-          if (current_level == 0)
-            instance.updateLB(instance.UB);
+        if (current_level > 0) {
+          // only for the heavier levels
+          nextLevel();
+          continue;
+        }
+        if (status == HSSolver::Status::Optimal) {
+          instance.updateLB(instance.UB);
           break;
         } else {
           if (instance.UB == instance.LB) {
@@ -278,11 +360,21 @@ void Solver::solveMaxHS() {
           }
           nNonoptCores += 1;
         }
+      } else if (cfg.nonoptPrimary && cfg.nonoptThreads > 1) {
+        nonopt_timer.start();
+        nonOpts = findNonoptCoresInParallel(*pool, hs, new_cores);
+        nNonoptCores += nonOpts;
+        if (instance.UB == instance.LB) {
+          log(1, "c solved by LB == UB\n");
+          nonopt_timer.stop();
+          goto maxhs_stop;
+        }
       } else if (cfg.nonoptPrimary) {
         nonopt_timer.start();
         while (true) {
           while (true) {
-            cfg.nonoptPrimary(hs, new_cores, cores, instance.bvar_weights, coreClauseCounts);
+            cfg.nonoptPrimary(hs, new_cores, core_db.cores(), instance.bvars, core_db.counts());
+            local_search.improve(hs, core_db.cores(), instance.bvars, cfg.nonoptLSTime);
             if (cfg.printHittingSets & PRINT_NONOPT_HS) {
               out << "c nonopt (1) hs " << hs << endl;
             }
@@ -302,7 +394,8 @@ void Solver::solveMaxHS() {
           }
           // second nonopt stage exists?
           if (not cfg.nonoptSecondary) break;
-          cfg.nonoptSecondary(hs, new_cores, cores, instance.bvar_weights, coreClauseCounts);
+          cfg.nonoptSecondary(hs, new_cores, core_db.cores(), instance.bvars, core_db.counts());
+          local_search.improve(hs, core_db.cores(), instance.bvars, cfg.nonoptLSTime);
           if (cfg.printHittingSets & PRINT_NONOPT_HS) {
             out << "c nonopt (2) hs " << hs << endl;
           }
@@ -328,7 +421,11 @@ void Solver::solveMaxHS() {
     } // end main MaxHS loop
 
   maxhs_stop:
-    
+
+  delete portfolio;
+  delete pool;
+  pool = nullptr;
+
   if (cfg.MIP_modelFile != "") {
     instance.mip_solver->exportModel(cfg.MIP_modelFile);
   }
@@ -336,11 +433,107 @@ void Solver::solveMaxHS() {
   instance.solve_timer.stop();
 }
 
+// Refutes batches of different non-optimal hitting sets in parallel until
+// every hitting set of a batch is satisfiable, returns the number of cores
+int Solver::findNonoptCoresInParallel(SolverPool & pool, vector<int>& hs,
+                                      vector<vector<int>>& new_cores) {
+  log(3, "c Solver::findNonoptCoresInParallel\n");
+
+  vector<vector<int>> batch;
+  vector<vector<int>> batch_cores;
+  int found = 0;
+
+  while (found < cfg.nonoptLimit) {
+    nonoptBatch(pool.size(), hs, new_cores, batch);
+    if (cfg.printHittingSets & PRINT_NONOPT_HS) {
+      for (auto & b : batch)
+        out << "c nonopt (parallel) hs " << b << endl;
+    }
+
+    pool.refute(batch, batch_cores);
+    instance.collectOfferedModel();
+
+    // keep the cores that contain no other core of the batch
+    for (auto & core : batch_cores) sort(core.begin(), core.end());
+    sort(batch_cores.begin(), batch_cores.end(),
+         [] (const vector<int> & a, const vector<int> & b) { return a.size() < b.size(); });
+
+    new_cores.clear();
+    for (auto & core : batch_cores) {
+      if (core.empty()) continue;
+      bool subsumed = any_of(new_cores.begin(), new_cores.end(), [&](const vector<int> & c) {
+          return includes(core.begin(), core.end(), c.begin(), c.end());
+        });
+      if (!subsumed) new_cores.push_back(core);
+    }
+    log(2, "c parallel nonopt: %lu hitting sets, %lu cores\n", batch.size(), new_cores.size());
+
+    if (new_cores.empty()) break;
+    for (auto & core : new_cores) processCore(core);
+    found += new_cores.size();
+
+    if (instance.UB == instance.LB) break;
+  }
+
+  return found;
+}
+
+// Up to n different non-optimal hitting sets of all cores. The first one
+// continues hs with the configured strategy, the others come from the
+// other strategies and random changes to it.
+void Solver::nonoptBatch(unsigned n, vector<int>& hs, const vector<vector<int>>& new_cores,
+                         vector<vector<int>>& batch) {
+  batch.clear();
+  set<vector<int>> seen;
+  auto add = [&](vector<int> & cand) {
+    sort(cand.begin(), cand.end());
+    if (batch.size() < n && seen.insert(cand).second) batch.push_back(cand);
+  };
+
+  vector<int> base(hs);
+  cfg.nonoptPrimary(hs, new_cores, core_db.cores(), instance.bvars, core_db.counts());
+  local_search.improve(hs, core_db.cores(), instance.bvars, cfg.nonoptLSTime);
+  vector<int> cand(hs);
+  add(cand);
+
+  if (batch_strategies.empty())
+    batch_strategies = { NonoptHS::greedy(), NonoptHS::disjoint, NonoptHS::common,
+                         NonoptHS::frac(cfg.fracSize) };
+  for (auto & strategy : batch_strategies) {
+    cand = base;
+    strategy(cand, new_cores, core_db.cores(), instance.bvars, core_db.counts());
+    add(cand);
+  }
+
+  // drop about a quarter of hs and hit the cores left over randomly
+  vector<bool> in_cand;
+  for (unsigned tries = 0; batch.size() < n && tries < 2 * n; ++tries) {
+    cand.clear();
+    in_cand.assign(instance.max_var + 1, false);
+    for (int b : hs) {
+      if (rand() % 4 == 0) continue;
+      cand.push_back(b);
+      in_cand[b] = true;
+    }
+    for (auto & core : core_db.cores()) {
+      if (any_of(core.begin(), core.end(), [&](int b) { return in_cand[b]; })) continue;
+      int b = core[rand() % core.size()];
+      cand.push_back(b);
+      in_cand[b] = true;
+    }
+    add(cand);
+  }
+}
+
 void Solver::processCore(vector<int> &core) {
   static int processed = 0;
   ++ processed;
   condTerminate(core.empty(), 1, "Error: attempting to process empty core.\n");
-  cores.push_back(core);
+
+  // the cores it evicts change the order of the others
+  unsigned long removed = core_db.nRemoved();
+  core_db.add(core);
+  if (core_db.nRemoved() != removed) NonoptHS::coresChanged();
 
   if (cfg.printCores) {
     out << "c core " << core << endl;
@@ -348,10 +541,7 @@ void Solver::processCore(vector<int> &core) {
 
   instance.mip_solver->addConstraint(core);
   coreSizes.push_back(core.size());
-  for (int b : core) {
-    coreClauseCounts[b]++;
-    assert(b > 0);
-  } 
+  for (int b : core) in_hs_solver.set(b);
 }
 
 //
@@ -370,7 +560,11 @@ void Solver::printStats() {
   log(0, "c   total cores:  %lu\n", coreSizes.size());
   condLog(cfg.doDisjointPhase, 0, "c   disjoints:    %d\n", nDisjointCores);
   condLog(cfg.nonoptPrimary != nullptr,        0, "c   from nonopt:  %d\n", nNonoptCores);
+  condLog(cfg.portfolio > 1,   0, "c   portfolio:    %d\n", nPortfolioCores);
   condLog(cfg.doEquivSeed,     0, "c   eq-constr:    %d\n", nEquivConstraints);
+  condLog(cfg.stratify,        0, "c   hardened:     %d\n", nHardened);
+  log(0, "c   subsumed:     %lu\n", core_db.nSubsumed());
+  log(0, "c   removed:      %lu\n", core_db.nRemoved());
 
   unsigned totalSize = 0;
   for (unsigned s : coreSizes) totalSize += s;
@@ -394,9 +588,16 @@ void Solver::printStats() {
 void Solver::setHSAssumptions(vector<int>& hs) {
   log(3, "c Solver::setHSAssumptions\n");
   
-  instance.sat_solver->unsetBvars();
-  for (int c : hs)
-    instance.sat_solver->setBvar(c);
+  if (current_level == 0) {
+    instance.sat_solver->relaxOnly(hs);
+  } else {
+    // the bvars of the lighter levels are left free
+    relaxed.assign(hs.begin(), hs.end());
+    for (int l = 0; l < current_level; ++l)
+      for (auto & w_b : levels[l])
+        if (instance.bvars.contains(w_b.second)) relaxed.push_back(w_b.second);
+    instance.sat_solver->relaxOnly(relaxed);
+  }
   instance.sat_solver->clearAssumptions();
   instance.sat_solver->assumeBvars();
 }
@@ -448,6 +649,22 @@ bool Solver::getCores(vector<int>& hs, vector<vector<int>>& cores) {
     return false;
   }
 
+  if (pool && cfg.minimizeThreads > 1) {
+    vector<vector<int>> reduced(cores);
+    instance.reduce_timer.start();
+    pool->minimize(reduced, cfg.minimizeThreads);
+    instance.reduce_timer.stop();
+    instance.collectOfferedModel();
+
+    for (auto & core : reduced) {
+      processCore(core);
+
+      if (cfg.doResetClauses) instance.sat_solver->deleteLearnts();
+      if (cfg.doInvertActivity) instance.sat_solver->invertActivity();
+    }
+    return true;
+  }
+
   for (auto core : cores) {
     if (cfg.doRerefuteCores) {
       instance.reduceCore(core, MinimizeAlgorithm::rerefute);
@@ -486,7 +703,7 @@ void Solver::findDisjointCores() {
 
     weight_t minCost = WEIGHT_MAX;
     for (int b : core)
-      minCost = min(minCost, instance.bvar_weights[b]);
+      minCost = min(minCost, instance.bvars.weightOf(b));
     cost += minCost;
     instance.updateLB(cost);
   }
@@ -494,7 +711,7 @@ void Solver::findDisjointCores() {
   cost = instance.getSolutionWeight(instance.sat_solver);
   instance.updateUB(cost);
 
-  log(1, "c Found %ld disjoint cores\n", cores.size());
+  log(1, "c Found %u disjoint cores\n", core_db.size());
     //cores.size(), instance.sat_solver->coresMinimized);
   
   disjoint_timer.stop();
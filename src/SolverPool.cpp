@@ -0,0 +1,235 @@
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <functional>  // ref, cref
+
+#include "SolverPool.h"
+#include "ProblemInstance.h"
+#include "GlobalConfig.h"
+#include "Util.h"
+
+using namespace std;
+
+SolverPool::SolverPool(ProblemInstance & instance, unsigned size)
+    : instance(instance),
+      n_clauses(instance.clauses.size()) {
+
+  GlobalConfig & cfg = GlobalConfig::get();
+
+  for (unsigned i = 0; i < size; ++i) {
+    MinisatSolver * s = new MinisatSolver();
+    // identical solvers would find the same cores
+    s->setRandomSeed(cfg.SAT_rndSeed + i + 1);
+    s->setRandomInitActivity(i > 0);
+    instance.loadClauses(s);
+    solvers.push_back(s);
+  }
+
+  for (unsigned i = 0; i < instance.bvars.size(); ++i)
+    bvar_list.push_back(instance.bvars.var(i));
+
+  // cardinality minimization adds variables to the instance
+  minAlg = cfg.minAlg == MinimizeAlgorithm::cardinality ?
+           MinimizeAlgorithm::destructive : cfg.minAlg;
+}
+
+SolverPool::~SolverPool() {
+  for (MinisatSolver * s : solvers) delete s;
+}
+
+void SolverPool::sync() {
+  // minimizers in the threads only read the occurrence lists
+  if (GlobalConfig::get().modelRotation) instance.rotation.sync();
+
+  unsigned n = instance.clauses.size();
+  if (n_clauses == n) return;
+
+  for (MinisatSolver * s : solvers) {
+    s->addVariable(instance.max_var);
+    for (unsigned id = n_clauses; id < n; ++id)
+      s->addConstraint(instance.clauses.begin(id), instance.clauses.end(id));
+  }
+  n_clauses = n;
+
+  // bvars hardened by forceBvar are no longer assumed
+  auto hardened = [&](int b) { return !instance.bvars.contains(b); };
+  for (int b : bvar_list)
+    if (hardened(b))
+      for (MinisatSolver * s : solvers) s->removeBvarAssumption(b);
+  bvar_list.erase(remove_if(bvar_list.begin(), bvar_list.end(), hardened), bvar_list.end());
+}
+
+void SolverPool::refute(const vector<vector<int>> & hitting_sets,
+                        vector<vector<int>> & cores) {
+  condTerminate(hitting_sets.size() > solvers.size(), 1,
+                "Error: more hitting sets than pooled solvers\n");
+  sync();
+
+  cores.resize(hitting_sets.size());
+
+  // the first hitting set is refuted by the calling thread
+  vector<thread> threads;
+  for (unsigned i = 1; i < hitting_sets.size(); ++i)
+    threads.emplace_back(&SolverPool::refuteWith, this, i,
+                         cref(hitting_sets[i]), ref(cores[i]));
+  if (hitting_sets.size())
+    refuteWith(0, hitting_sets[0], cores[0]);
+
+  for (thread & t : threads) t.join();
+}
+
+void SolverPool::minimize(vector<vector<int>> & cores, unsigned n_threads) {
+  GlobalConfig & cfg = GlobalConfig::get();
+  sync();
+
+  // a single core is minimized by all threads together
+  if (cores.size() == 1 && minAlg == MinimizeAlgorithm::destructive &&
+      cfg.doMinimizeCores && n_threads > 1) {
+    if (cfg.doRerefuteCores)
+      instance.reduceCore(cores[0], MinimizeAlgorithm::rerefute, solvers[0]);
+    destructiveMinimize(cores[0], min(n_threads, size()));
+    return;
+  }
+
+  n_threads = min(n_threads, min(size(), unsigned(cores.size())));
+
+  // each thread takes the next core left, as minimization
+  // times vary a lot between cores
+  atomic<unsigned> next(0);
+  auto work = [&](unsigned i) {
+    for (unsigned k = next++; k < cores.size(); k = next++)
+      reduce(i, cores[k]);
+  };
+
+  vector<thread> threads;
+  for (unsigned i = 1; i < n_threads; ++i)
+    threads.emplace_back(work, i);
+  work(0);
+
+  for (thread & t : threads) t.join();
+}
+
+void SolverPool::refuteWith(unsigned i, const vector<int> & hs, vector<int> & core) {
+  MinisatSolver * s = solvers[i];
+
+  s->relaxOnly(hs);
+  s->clearAssumptions();
+  s->assumeBvars();
+
+  s->findCore(core);
+  if (core.empty()) {
+    instance.offerModel(s);
+    return;
+  }
+
+  reduce(i, core);
+}
+
+void SolverPool::reduce(unsigned i, vector<int> & core) {
+  GlobalConfig & cfg = GlobalConfig::get();
+
+  if (cfg.doRerefuteCores)
+    instance.reduceCore(core, MinimizeAlgorithm::rerefute, solvers[i]);
+  if (cfg.doMinimizeCores)
+    instance.reduceCore(core, minAlg, solvers[i]);
+}
+
+// Destructive minimization testing the removal of n_threads members at
+// a time. A satisfiable test proves its member critical, also for every
+// subset of the core, and model rotation may prove others critical. The
+// smallest core found by the unsatisfiable tests replaces the core, and
+// contains every member proved critical so far.
+void SolverPool::destructiveMinimize(vector<int> & core, unsigned n_threads) {
+  GlobalConfig & cfg = GlobalConfig::get();
+  log(3, "c SolverPool::destructiveMinimize (size %lu)\n", core.size());
+
+  instance.rotation.sync();
+  instance.sortByWeight(core);
+
+  // the budgets are for the whole core in each solver
+  bool limited = false;
+  for (unsigned i = 0; i < n_threads; ++i)
+    limited = instance.setMinimizeBudget(solvers[i]);
+
+  // candidates of the round, the outcome of each test and
+  // the subcore or the model it found
+  vector<int> tests;
+  vector<char> outcome(n_threads);
+  vector<vector<int>> subcores(n_threads);
+  vector<vector<bool>> models(n_threads);
+  vector<vector<int>> sets(n_threads);
+  enum { unsat, sat, unknown };
+
+  auto test = [&](unsigned i) {
+    MinisatSolver * s = solvers[i];
+
+    vector<int> & set = sets[i];
+    set.clear();
+    for (int b : core)
+      if (b != tests[i]) set.push_back(b);
+    s->activateOnly(set);
+    s->clearAssumptions();
+    s->assumeBvars();
+
+    if (limited) {
+      if (!s->findCoreLimited(subcores[i])) {
+        outcome[i] = unknown;
+        return;
+      }
+    } else {
+      s->findCore(subcores[i]);
+    }
+
+    if (subcores[i].size()) {
+      outcome[i] = unsat;
+    } else {
+      outcome[i] = sat;
+      s->getModel(models[i]);
+      instance.offerModel(s);
+    }
+  };
+
+  VarFlags critical;
+  int calls = 0;
+  bool stop = false;
+
+  while (!stop) {
+    tests.clear();
+    for (int b : core) {
+      if (tests.size() == n_threads) break;
+      if (!critical[b]) tests.push_back(b);
+    }
+    if (tests.empty()) break;
+
+    calls += tests.size();
+    if (calls > cfg.minimizeLimit) break;
+
+    vector<thread> threads;
+    for (unsigned i = 1; i < tests.size(); ++i)
+      threads.emplace_back(test, i);
+    test(0);
+    for (thread & t : threads) t.join();
+
+    int smallest = -1;
+    vector<int> rotated;
+    for (unsigned i = 0; i < tests.size(); ++i) {
+      if (outcome[i] == unknown) {
+        // stop minimization on exceeding resource budgets
+        stop = true;
+      } else if (outcome[i] == sat) {
+        critical.set(tests[i]);
+        instance.rotation.rotate(models[i], tests[i], core, rotated, cfg.recursiveRotation);
+      } else if (smallest < 0 || subcores[i].size() < subcores[smallest].size()) {
+        smallest = i;
+      }
+    }
+    for (int b : rotated) critical.set(b);
+
+    if (smallest >= 0) {
+      core.swap(subcores[smallest]);
+      instance.sortByWeight(core);
+    }
+  }
+
+  assert(core.size());
+}
@@ -1,166 +1,431 @@
 // adapted from minisat dimacs.h
 #include <algorithm>
 #include <istream>
-#include <ostream>
-#include <iostream>
+#include <cstring>  // memchr, memcmp, memcpy, memmove
+#include <cstdlib>  // strtod
+#include <climits>  // INT_MAX
+#include <cstdio>   // printf
 #include <string>
-#include <sstream>
 #include <cassert>
-#include <unordered_set>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "WCNFParser.h"
+#include "VarMapper.h"
+#include "ChunkReader.h"
 #include "Util.h"
-#include "GlobalConfig.h"
 #include "Weights.h"
 
 using namespace std;
 
-bool weighted;
+namespace {
 
-void skipLine(istream &in) {
-  for (;;) {
-    if (in.eof()) return;
-    if (in.peek() == '\n') {
-      in.get();
-      return;
+inline bool isSpace(char c) { return c == ' ' || (c >= 9 && c <= 13); }
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Tokenizer over one buffer of wcnf text. Unless the buffer is the last
+// one, running into its end in the middle of a token or line sets
+// 'starved', and the caller retries the current item with more data.
+struct Scanner {
+  Scanner(const char * begin, const char * end, bool last)
+    : p(begin), end(end), last(last), starved(false) { }
+
+  const char * p;
+  const char * end;
+  bool last;
+  bool starved;
+
+  void hitEnd(const char * expected) {
+    if (!last) starved = true;
+    else terminate(1, "WCNF parse error - unexpected end of input, expected %s\n", expected);
+  }
+
+  // skip to the first character of the next line
+  // (memchr is vectorized in glibc, so long comment lines are cheap)
+  void skipLine() {
+    const char * nl = (const char *) memchr(p, '\n', end - p);
+    if (!nl && !last) starved = true;
+    p = nl ? nl + 1 : end;
+  }
+
+  void skipWhitespace() {
+    while (p != end && isSpace(*p)) ++p;
+  }
+
+  // skip spaces and tabs, but not line breaks
+  void scanNext() {
+    while (p != end && (*p == ' ' || *p == '\t')) ++p;
+    if (p == end && !last) starved = true;
+  }
+
+  bool eagerMatch(const char * str) {
+    size_t n = strlen(str);
+    if (size_t(end - p) < n) {
+      if (!last && !memcmp(p, str, end - p)) starved = true;
+      return false;
+    }
+    if (memcmp(p, str, n)) return false;
+    p += n;
+    return true;
+  }
+
+  int parseInt() {
+    skipWhitespace();
+    bool neg = false;
+    if (p != end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+    if (p == end) {
+      hitEnd("integer");
+      return 0;
+    }
+    if (!isDigit(*p))
+      terminate(1, "WCNF parse error - expected integer\n");
+
+    long long v = 0;
+    while (p != end && isDigit(*p)) {
+      v = v * 10 + (*p++ - '0');
+      if (v > INT_MAX) terminate(1, "WCNF parse error - literal out of range\n");
     }
-    in.get();
+    if (p == end && !last) starved = true;
+    return neg ? -int(v) : int(v);
   }
+
+  weight_t parseWeight() {
+    skipWhitespace();
+    if (p == end) {
+      hitEnd("clause weight");
+      return 0;
+    }
+#if defined(FLOAT_WEIGHTS)
+    // the buffer is not null-terminated, copy the token for strtod
+    char buf[64];
+    unsigned n = 0;
+    while (p != end && !isSpace(*p) && n < sizeof(buf) - 1) buf[n++] = *p++;
+    buf[n] = '\0';
+    if (p == end && !last) {
+      starved = true;
+      return 0;
+    }
+    char * tok_end;
+    weight_t w = strtod(buf, &tok_end);
+    if (n == 0 || *tok_end != '\0')
+      terminate(1, "WCNF parse error - bad clause weight\n");
+    return w;
+#else
+    if (!isDigit(*p))
+      terminate(1, "WCNF parse error - bad clause weight\n");
+    weight_t w = 0;
+    while (p != end && isDigit(*p)) {
+      weight_t d = *p++ - '0';
+      if (w > (UINT64_MAX - d) / 10)
+        terminate(1, "WCNF parse error - clause weight out of range\n");
+      w = w * 10 + d;
+    }
+    if (p == end && !last) starved = true;
+    return w;
+#endif
+  }
+};
+
+inline void markVar(vector<bool> & seen, int v) {
+  if (unsigned(v) >= seen.size()) seen.resize(max(2 * seen.size(), size_t(v) + 1));
+  seen[v] = true;
 }
 
-bool eagerMatch(istream & in, const char* str) {
-  for (; *str != '\0'; ++str, in.get())
-    if (*str != in.peek()) return false;
-  return true;
+// parser state carried over from one buffer to the next
+struct ParseState {
+  ParseState(WCNFData & out, VarMapper * varmap)
+    : out(out), varmap(varmap), p_line_parsed(false), headerless(false) { }
+
+  WCNFData & out;
+  VarMapper * varmap;
+  bool p_line_parsed;
+  // 2022+ format: no 'p' line, hard clauses start with 'h'
+  bool headerless;
+  vector<bool> parsed_vars;
+};
+
+// Hard clauses of the headerless format get weight WEIGHT_MAX until
+// top is known at the end of the input.
+void readClause(Scanner & in, ParseState & st, bool hard) {
+  WCNFData & out = st.out;
+  weight_t w = hard ? WEIGHT_MAX : out.weighted ? in.parseWeight() : 1;
+
+  if (st.headerless && !hard && w >= weight_t(WEIGHT_MAX) && !in.starved)
+    terminate(1, "WCNF parse error - soft clause weight out of range\n");
+
+  for (;;) {
+    int lit = in.parseInt();
+    if (in.starved) return;
+    if (lit == 0) break;
+    int v = abs(lit);
+    out.n_vars = max(v, out.n_vars);
+    if (st.varmap) {
+      lit = st.varmap->mapLit(lit);
+    } else {
+      markVar(st.parsed_vars, v);
+    }
+    out.lits.push_back(lit);
+  }
+
+  if (w != 0) {
+    out.offsets.push_back(out.lits.size());
+    out.weights.push_back(w);
+  } else {
+    // skip all 0-weight clauses
+    out.lits.resize(out.offsets.back());
+  }
 }
 
-void skipWhitespace(istream & in) {
-  char c = in.peek();
-  while (!in.eof() && ((c >= 9 && c <= 13) || c == 32)) {
-    in.get();
-    c = in.peek();
+void parseHeader(Scanner & in, WCNFData & out) {
+  const char * line_begin = in.p;
+  ++in.p; // chomp 'p'
+  in.scanNext();
+
+  if (in.eagerMatch("wcnf")) {
+    out.weighted = true;
+  } else if (in.eagerMatch("cnf")) {
+    out.weighted = false;
+  } else {
+    if (in.starved) return;
+    const char * nl = (const char *) memchr(line_begin, '\n', in.end - line_begin);
+    string line(line_begin, nl ? nl : in.end);
+    terminate(1, "WCNF parse error - unexpected 'p' line:\n%s\n", line.c_str());
   }
+
+  int n_vars = in.parseInt();
+  unsigned n_clauses = in.parseInt();
+
+  // top may still follow in the next buffer
+  in.scanNext();
+  if (in.starved) return;
+
+  out.n_vars = max(out.n_vars, n_vars);
+  if (out.weighted && in.p != in.end && !isSpace(*in.p))
+    out.top = in.parseWeight();
+  else
+    out.top = WEIGHT_MAX;
+
+  out.offsets.reserve(n_clauses + 1);
+  out.weights.reserve(n_clauses);
 }
 
-void scanNext(istream & in) { 
-  char c = in.peek();
-  while (!in.eof() && (c == ' ' || c == '\t')) {
-    in.get();
-    c = in.peek(); 
+void parseItem(Scanner & in, ParseState & st) {
+  WCNFData & out = st.out;
+
+  switch (*in.p) {
+    case 'p':
+      if (st.headerless)
+        terminate(1, "WCNF parse error - 'p' line after clauses\n");
+      parseHeader(in, out);
+      st.p_line_parsed = true;
+      break;
+    case 'c':
+      if (in.eagerMatch("c assumptions")) {
+        in.scanNext();
+        while (!in.starved && in.p != in.end && *in.p != '\n' && *in.p != '\r') {
+          int a = in.parseInt();
+          if (a != 0) out.assumptions.push_back(a);
+          in.scanNext();
+        }
+      }
+      if (!in.starved) in.skipLine();
+      break;
+    case 'b':
+      ++in.p;
+      for (;;) {
+        int v = in.parseInt();
+        if (v == 0 || in.starved) break;
+        out.branchVars.push_back(v);
+      }
+      break;
+    case 'h':
+      if (st.p_line_parsed)
+        terminate(1, "WCNF parse error - 'h' clause in a file with a 'p' line\n");
+      ++in.p;
+      st.headerless = true;
+      readClause(in, st, true);
+      break;
+    default:
+      if (!st.p_line_parsed) st.headerless = true;
+      readClause(in, st, false);
   }
 }
 
-void readClause(istream & in, weight_t& out_w, vector<int>& out_lits, int& n_vars, unordered_set<int>& prob_vars) {
-  int parsed_lit;
+// Parse the items in [begin, end). Unless last is set, an item cut off
+// by the end of the buffer is rolled back.
+// returns the number of bytes consumed
+size_t parseBuffer(const char * begin, const char * end, bool last,
+                   ParseState & st) {
+  WCNFData & out = st.out;
+  Scanner in(begin, end, last);
 
-  if (weighted) {
-    if (!(in >> out_w)) {
-      terminate(1, "WCNF parse error - bad clause weight\n");
+  for (;;) {
+    in.skipWhitespace();
+    if (in.p == end) break;
+
+    const char * item = in.p;
+    size_t n_lits = out.lits.size();
+    size_t n_assumptions = out.assumptions.size();
+    size_t n_branch = out.branchVars.size();
+
+    parseItem(in, st);
+
+    if (in.starved) {
+      out.lits.resize(n_lits);
+      out.assumptions.resize(n_assumptions);
+      out.branchVars.resize(n_branch);
+      return item - begin;
     }
+  }
+
+  return end - begin;
+}
+
+void finishParse(ParseState & st) {
+  WCNFData & out = st.out;
+  VarMapper * varmap = st.varmap;
+
+  if (st.headerless) {
+    // top is one more than the sum of soft weights
+    weight_t soft_sum = 0;
+    for (weight_t w : out.weights)
+      if (w != weight_t(WEIGHT_MAX) && !addWeight(soft_sum, w))
+        terminate(1, "Error: Sum of soft weights exceeds max weight\n");
+    out.top = soft_sum + 1;
+    for (weight_t & w : out.weights)
+      if (w == weight_t(WEIGHT_MAX)) w = out.top;
+  }
+
+  if (varmap) {
+    varmap->n_vars = out.n_vars;
+    varmap->mapExisting(out.branchVars);
+    varmap->mapExisting(out.assumptions);
+    out.n_vars = varmap->nMapped();
+    printf("c Parsed %d vars\n", out.n_vars);
   } else {
-    out_w = 1;
+    printf("c Parsed %lu vars\n", (unsigned long) count(st.parsed_vars.begin(), st.parsed_vars.end(), true));
   }
+}
+
+// Parse text delivered piecewise by read(dst, n), which returns the
+// number of bytes written to dst, 0 at end of input. The unparsed tail
+// of each piece is carried over to the front of the buffer.
+template <class Read>
+void parseIncremental(Read read, size_t chunk_size, ParseState & st) {
+  vector<char> buf(chunk_size);
+  size_t n = 0;
 
-  int lits = 0;
   for (;;) {
-    in >> parsed_lit;
-    if (parsed_lit == 0) {
-      assert(lits);
-      break;
-    }
-    prob_vars.insert(abs(parsed_lit));
-    ++lits;
-    n_vars = max(abs(parsed_lit), n_vars);
-    out_lits.push_back(parsed_lit);
+    // grow only if a single item does not fit
+    if (buf.size() - n < chunk_size / 2) buf.resize(n + chunk_size);
+    size_t r = read(buf.data() + n, buf.size() - n);
+    n += r;
+
+    size_t used = parseBuffer(buf.data(), buf.data() + n, r == 0, st);
+    memmove(buf.data(), buf.data() + used, n - used);
+    n -= used;
+
+    if (r == 0) break;
   }
 }
 
-void parseWCNF(istream & wcnf_in, vector<weight_t>& out_weights,
-               vector<int>& out_branchVars, weight_t& out_top,
-               vector<vector<int> >& out_clauses, 
-               vector<int>& file_assumptions, int& n_vars) {
-  unsigned n_clauses = 0, cnt = 0, soft_ct = 0, hard_ct = 0;
+} // namespace
 
-  weight_t w = 0;
+void parseWCNF(const char * begin, const char * end, WCNFData & out,
+               VarMapper * varmap) {
+  ParseState st(out, varmap);
+  parseBuffer(begin, end, true, st);
+  finishParse(st);
+}
 
-  bool p_line_parsed = false;
+void parseWCNF(istream & wcnf_in, WCNFData & out, VarMapper * varmap) {
+  ParseState st(out, varmap);
+  parseIncremental([&](char * dst, size_t n) -> size_t {
+    wcnf_in.read(dst, n);
+    return wcnf_in.gcount();
+  }, 1 << 20, st);
+  finishParse(st);
+}
 
-  unordered_set<int> parsed_vars;
+namespace {
 
-  for (;;) {
-    skipWhitespace(wcnf_in);
-    if (wcnf_in.eof()) {
-      break;
-    } else {
-      switch(wcnf_in.peek()) {
-        case 'p':
-        {
-          string line;
-          getline(wcnf_in, line);
-          stringstream pline(line);
-          pline.get(); // chomp 'p'
-          string type;
-          pline >> type >> n_vars >> n_clauses;
-          weighted = (type == "wcnf");
-          if (weighted) {
-            if (!(pline >> out_top)) out_top = WEIGHT_MAX;
-          } else if (type == "cnf") {
-            out_top = WEIGHT_MAX;
-          } else {
-            terminate(1, "WCNF parse error - unexpected 'p' line:\n%s\n", line.c_str());
-          }
-          out_clauses.reserve(n_clauses);
-          p_line_parsed = true;
-          break;
-        }
-        case 'c':
-        {
-          if (eagerMatch(wcnf_in, "c assumptions")) {
-            scanNext(wcnf_in);        
-            int c = wcnf_in.peek();
-            while(!wcnf_in.eof() && c != '\n' && c != 0) {
-              int a;
-              wcnf_in >> a;
-              file_assumptions.push_back(a);
-              scanNext(wcnf_in);
-              c = wcnf_in.peek();
-            }
-          }
-          skipLine(wcnf_in);
-          break;
-        }
-        case 'b':
-        {
-          wcnf_in.get();
-          for (;;) {
-            int v;
-            wcnf_in >> v;
-            if (v == 0) break;
-            out_branchVars.push_back(v);
-          }
+// compressed input: decompression runs on a second thread while parsing
+bool parseCompressedFile(const char * filepath, ChunkReader::Format format,
+                         WCNFData & out, VarMapper * varmap) {
+  condTerminate(!ChunkReader::supported(format), 1,
+    "Error: support for the compression format of %s was not compiled in\n", filepath);
+
+  ChunkReader reader(filepath, format);
+  if (reader.fail()) return false;
+
+  ParseState st(out, varmap);
+  vector<char> chunk;
+  size_t pos = 0;
+
+  parseIncremental([&](char * dst, size_t n) -> size_t {
+    size_t copied = 0;
+    while (copied < n) {
+      if (pos == chunk.size()) {
+        pos = 0;
+        if (!reader.next(chunk)) {
+          condTerminate(reader.error(), 1, "Error: could not decompress %s\n", filepath);
           break;
         }
-        default:
-        {
-          if (!p_line_parsed) 
-            terminate(1, "WCNF parse error - clause read attempt before 'p' line\n");
-          cnt++;
-          out_clauses.push_back(vector<int>());
-          readClause(wcnf_in, w, out_clauses.back(), n_vars, parsed_vars);
-
-          if (w != 0) {
-            // skip all 0-weight clauses
-            if (w == out_top) ++hard_ct;
-            else              ++soft_ct;
-
-            out_weights.push_back(w);
-          } else {
-            out_clauses.pop_back();
-          }
-        }
       }
+      size_t k = min(n - copied, chunk.size() - pos);
+      memcpy(dst + copied, chunk.data() + pos, k);
+      copied += k;
+      pos += k;
     }
+    return copied;
+  }, 1 << 20, st);
+
+  finishParse(st);
+  return true;
+}
+
+} // namespace
+
+bool parseWCNFFile(const char * filepath, WCNFData & out, VarMapper * varmap) {
+  ChunkReader::Format format = ChunkReader::detectFormat(filepath);
+  if (format != ChunkReader::Plain)
+    return parseCompressedFile(filepath, format, out, varmap);
+
+  int fd = open(filepath, O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+
+  size_t size = st.st_size;
+  void * data = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)
+                     : MAP_FAILED;
+
+  if (data == MAP_FAILED) {
+    // empty files, pipes etc. cannot be mapped: read them instead
+    ParseState state(out, varmap);
+    parseIncremental([&](char * dst, size_t n) -> size_t {
+      ssize_t r = read(fd, dst, n);
+      return r > 0 ? r : 0;
+    }, 1 << 20, state);
+    close(fd);
+    finishParse(state);
+    return true;
   }
 
-  printf("c Parsed %lu vars\n", parsed_vars.size());
-}
\ No newline at end of file
+  madvise(data, size, MADV_SEQUENTIAL);
+  close(fd);
+
+  const char * begin = (const char *) data;
+  parseWCNF(begin, begin + size, out, varmap);
+
+  munmap(data, size);
+  return true;
+}
@@ -51,6 +51,11 @@ def verify(solver_output, instance):
 				topw = float(tokens[4])
 			else:
 				topw = 2**63;
+		elif tokens[0] == 'h':
+			lits = list(map(int, tokens[1:-1]))
+			if not sat(lits, model):
+				return (False, "Hard clause " + str(lits) + " UNSAT")
+			variables |= set(abs(l) for l in lits)
 		elif tokens[0][0].isdigit() or (not weighted and tokens[0][0] == '-'):
 			lits = list(map(int, tokens[:-1]))
 			if not weighted: